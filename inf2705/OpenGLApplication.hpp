@@ -60,6 +60,8 @@ public:
 
 		settings_ = settings;
 
+		preload(); // À surcharger
+
 		// Créer la fenêtre et afficher les infos du contexte OpenGL.
 		createWindowAndContext(title);
 		printGLInfo();
@@ -238,6 +240,9 @@ public:
 
 	// Les méthodes virtuelles suivantes sont à surcharger.
 
+	// Appelée avant la création de la fenêtre et du contexte OpenGL, pour lancer en arrière-plan ce qui n'en dépend pas (ex. lecture des fichiers). Aucun appel OpenGL n'y est permis.
+	virtual void preload() { }
+
 	// Appelée avant la première trame.
 	virtual void init() { }
 
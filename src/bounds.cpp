@@ -0,0 +1,27 @@
+#include "bounds.hpp"
+
+#include <algorithm>
+
+Bounds Bounds::transformed(const glm::mat4 &transform) const {
+  // Le centre de la boîte suit la transformation; sa demi-taille sur chaque
+  // axe du monde est la somme des projections de ses demi-côtés.
+  glm::mat3 linear(transform);
+  glm::mat3 absolute(glm::abs(linear[0]), glm::abs(linear[1]),
+                     glm::abs(linear[2]));
+  glm::vec3 center = glm::vec3(transform * glm::vec4(box.center(), 1.0f));
+  glm::vec3 extents = absolute * box.extents();
+
+  float scale = std::max({glm::length(linear[0]), glm::length(linear[1]),
+                          glm::length(linear[2])});
+
+  Bounds result;
+  result.box = {center - extents, center + extents};
+  result.sphere.center =
+      glm::vec3(transform * glm::vec4(sphere.center, 1.0f));
+  result.sphere.radius = sphere.radius * scale;
+  return result;
+}
+
+BoundingSphere enclosingSphere(const BoundingBox &box) {
+  return {box.center(), glm::length(box.extents())};
+}
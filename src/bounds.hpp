@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Boîte englobante alignée sur les axes.
+struct BoundingBox {
+  glm::vec3 min = glm::vec3(0.0f);
+  glm::vec3 max = glm::vec3(0.0f);
+
+  glm::vec3 center() const { return (min + max) * 0.5f; }
+
+  glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+  // Agrandit la boîte pour qu'elle englobe aussi other.
+  void expand(const BoundingBox &other) {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+  }
+};
+
+struct BoundingSphere {
+  glm::vec3 center = glm::vec3(0.0f);
+  float radius = 0.0f;
+};
+
+// Volumes englobants d'un modèle, dans son espace ou dans celui du monde.
+struct Bounds {
+  BoundingBox box;
+  BoundingSphere sphere;
+
+  // Volumes englobant le modèle transformé par transform: la boîte englobe la
+  // boîte transformée et le rayon de la sphère suit la plus grande échelle.
+  Bounds transformed(const glm::mat4 &transform) const;
+};
+
+// Sphère qui englobe la boîte.
+BoundingSphere enclosingSphere(const BoundingBox &box);
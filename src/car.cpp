@@ -1,5 +1,6 @@
 #include "car.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
@@ -9,25 +10,55 @@
 using namespace gl;
 using namespace glm;
 
+namespace {
+
+const glm::vec3 FRAME_POSITION(0.0f, 0.25f, 0.0f);
+
+const glm::vec3 WHEEL_POSITIONS[] = {
+    glm::vec3(-1.29f, 0.245f, -0.57f), glm::vec3(-1.29f, 0.245f, 0.57f),
+    glm::vec3(1.4f, 0.245f, -0.57f), glm::vec3(1.4f, 0.245f, 0.57f)};
+
+// Distance entre l'axe de braquage et l'origine du modèle de la roue.
+const float WHEEL_PIVOT_OFFSET = 0.10124f;
+
+// Positions des phares dans le repère du châssis.
+const glm::vec3 HEADLIGHT_POSITIONS[] = {
+    glm::vec3(-1.9650f, 0.38f, -0.45f), glm::vec3(-1.9650f, 0.38f, 0.45f),
+    glm::vec3(2.0019f, 0.38f, -0.45f), glm::vec3(2.0019f, 0.38f, 0.45f)};
+
+// Décalages de la lumière et du clignotant dans le repère du phare.
+const float LIGHT_OFFSET = 0.029f;
+const float BLINKER_OFFSET = 0.06065f;
+
+// Rayon de la sphère centrée à l'origine qui englobe, pour toute rotation
+// autour de l'origine, un modèle décalé de offset.
+float rotationRadius(const Model &model, float offset) {
+  const BoundingSphere &sphere = model.bounds().sphere;
+  return offset + glm::length(sphere.center) + sphere.radius;
+}
+
+} // namespace
+
 Car::Car()
     : position(0.0f, 0.0f, 0.0f), orientation(0.0f, 0.0f), speed(0.f),
       wheelsRollAngle(0.f), steeringAngle(0.f), isHeadlightOn(false),
       isBraking(false), isLeftBlinkerActivated(false),
-      isRightBlinkerActivated(false), isBlinkerOn(false), blinkerTimer(0.f),
-      lastColorMod_(-1.0f, -1.0f, -1.0f) {}
-
-void Car::setColorMod(const glm::vec3 &color) {
-  if (glm::all(glm::equal(color, lastColorMod_)))
-    return;
-  glUniform3f(colorModUniformLocation, color.r, color.g, color.b);
-  lastColorMod_ = color;
+      isRightBlinkerActivated(false), isBlinkerOn(false), blinkerTimer(0.f) {}
+
+void Car::loadModels(ModelRegistry &registry, ModelLoader &loader) {
+  MeshLoadOptions options;
+  options.weldVertices = true;
+  options.optimizeVertexOrder = true;
+  options.lodLevels = 4;
+  frame_ = registry.acquire("../models/frame.ply", loader, options);
+  wheel_ = registry.acquire("../models/wheel.ply", loader, options);
+  blinker_ = registry.acquire("../models/blinker.ply", loader, options);
+  light_ = registry.acquire("../models/light.ply", loader, options);
+  buildSceneGraph();
 }
 
-void Car::loadModels() {
-  frame_.load("../models/frame.ply");
-  wheel_.load("../models/wheel.ply");
-  blinker_.load("../models/blinker.ply");
-  light_.load("../models/light.ply");
+std::vector<const Model *> Car::models() const {
+  return {frame_.get(), wheel_.get(), blinker_.get(), light_.get()};
 }
 
 void Car::update(float deltaTime) {
@@ -76,97 +107,139 @@ void Car::update(float deltaTime) {
   }
 }
 
-void Car::draw(glm::mat4 &projView) {
-  glm::mat4 carModel = glm::rotate(glm::translate(glm::mat4(1.0f), position),
-                                   orientation.y, {0, 1, 0});
-  drawFrame(projView, carModel);
-  drawWheels(projView, carModel);
+glm::mat4 Car::modelMatrix() const {
+  return glm::rotate(glm::translate(glm::mat4(1.0f), position), orientation.y,
+                     {0, 1, 0});
 }
 
-void Car::drawFrame(glm::mat4 &projView, glm::mat4 carModel) {
-  glm::mat4 frameModel = glm::translate(carModel, {0, 0.25f, 0});
-  glUniformMatrix4fv(mvpUniformLocation, 1, GL_FALSE,
-                     glm::value_ptr(projView * frameModel));
-  setColorMod({1, 1, 1});
-  frame_.draw();
-  drawHeadlights(projView, frameModel);
+glm::mat4 Car::wheelSpin(int i) const {
+  bool isLeft = WHEEL_POSITIONS[i].z < 0;
+  float side = isLeft ? 1.0f : -1.0f;
+  glm::mat4 spin(1.0f);
+  if (i < 2)
+    spin = glm::rotate(spin, side * glm::radians(steeringAngle), {0, 1, 0});
+  spin = glm::rotate(spin, side * wheelsRollAngle, {0, 0, 1});
+  return glm::translate(spin, {0, 0, -WHEEL_PIVOT_OFFSET});
 }
 
-void Car::drawWheel(glm::mat4 &projView, glm::mat4 wheelModel,
-                    bool isFrontWheel) {
-  bool isLeft = wheelModel[3][2] < 0;
-  // Rotation pour que la jante soit vers l'extérieur pour les roues de droite.
-  if (!isLeft)
-    wheelModel = glm::rotate(wheelModel, glm::pi<float>(), {0, 1, 0});
-
-  // Changement de l'axe de rotation (0.10124 unité vers l'intérieur).
-  wheelModel = glm::translate(wheelModel, {0, 0, 0.10124f});
-  if (isFrontWheel)
-    wheelModel = glm::rotate(
-        wheelModel, (isLeft ? 1.0f : -1.0f) * glm::radians(steeringAngle),
-        {0, 1, 0});
-  wheelModel = glm::rotate(
-      wheelModel, (isLeft ? 1.0f : -1.0f) * wheelsRollAngle, {0, 0, 1});
-  wheelModel = glm::translate(wheelModel, {0, 0, -0.10124f});
-
-  glUniformMatrix4fv(mvpUniformLocation, 1, GL_FALSE,
-                     glm::value_ptr(projView * wheelModel));
-  setColorMod({1, 1, 1});
-  wheel_.draw();
+void Car::prepareDraw(ObjectBuffer &objects) {
+  // Seuls les nœuds sous la voiture, si elle a bougé, ou sous une roue qui a
+  // tourné sont recalculés.
+  sceneGraph_.setLocal(carNode_, modelMatrix());
+  for (int i = 0; i < 4; ++i)
+    sceneGraph_.setLocal(wheelSpinNodes_[i], wheelSpin(i));
+  sceneGraph_.update();
+
+  updateColorMods();
+  for (Part &part : parts_) {
+    const glm::mat4 &matrix = sceneGraph_.world(part.node);
+    part.worldBounds = part.model->bounds().transformed(matrix);
+    part.object = objects.push(matrix);
+  }
 }
 
-void Car::drawWheels(glm::mat4 &projView, glm::mat4 carModel) {
-  const glm::vec3 WHEEL_POSITIONS[] = {
-      glm::vec3(-1.29f, 0.245f, -0.57f), glm::vec3(-1.29f, 0.245f, 0.57f),
-      glm::vec3(1.4f, 0.245f, -0.57f), glm::vec3(1.4f, 0.245f, 0.57f)};
-  for (int i = 0; i < 4; ++i)
-    drawWheel(projView, glm::translate(carModel, WHEEL_POSITIONS[i]), i < 2);
+void Car::submitDraw(RenderQueue &queue, GLuint program,
+                     const glm::mat4 &projView) const {
+  for (const Part &part : parts_) {
+    DrawPacket packet;
+    packet.program = program;
+    packet.model = part.model;
+    packet.firstObject = part.object;
+    packet.lod = part.model->selectLod(projView, part.worldBounds);
+    packet.colorMod = part.colorMod;
+    queue.submit(packet, queue.depth(part.worldBounds));
+  }
 }
 
-void Car::drawBlinker(glm::mat4 &projView, glm::mat4 headlightModel,
-                      bool isLeftHeadlight) {
-  // Positionnement à z=0.06065 du côté extérieur.
-  glm::mat4 blinkerModel = glm::translate(
-      headlightModel, {0, 0, isLeftHeadlight ? -0.06065f : 0.06065f});
-  bool isBlinkerActivated = (isLeftHeadlight && isLeftBlinkerActivated) ||
-                            (!isLeftHeadlight && isRightBlinkerActivated);
-
-  glUniformMatrix4fv(mvpUniformLocation, 1, GL_FALSE,
-                     glm::value_ptr(projView * blinkerModel));
-  setColorMod(isBlinkerOn && isBlinkerActivated
-                  ? glm::vec3(1.0f, 0.7f, 0.3f)
-                  : glm::vec3(0.5f, 0.35f, 0.15f));
-  blinker_.draw();
+Bounds Car::worldBounds() const {
+  // Boîte dans le repère de la voiture: le châssis, une sphère par phare et
+  // une sphère par roue, valables pour tout angle de braquage et de rotation
+  // (les roues tournent autour d'axes décalés d'au plus WHEEL_PIVOT_OFFSET de
+  // leur origine).
+  BoundingBox box =
+      frame_->bounds()
+          .transformed(glm::translate(glm::mat4(1.0f), FRAME_POSITION))
+          .box;
+  float headlightRadius = std::max(rotationRadius(*light_, LIGHT_OFFSET),
+                                   rotationRadius(*blinker_, BLINKER_OFFSET));
+  for (const glm::vec3 &headlightPosition : HEADLIGHT_POSITIONS) {
+    glm::vec3 center = FRAME_POSITION + headlightPosition;
+    box.expand({center - headlightRadius, center + headlightRadius});
+  }
+  float wheelRadius = rotationRadius(*wheel_, 2.0f * WHEEL_PIVOT_OFFSET);
+  for (const glm::vec3 &wheelPosition : WHEEL_POSITIONS)
+    box.expand({wheelPosition - wheelRadius, wheelPosition + wheelRadius});
+
+  Bounds local;
+  local.box = box;
+  local.sphere = enclosingSphere(box);
+  return local.transformed(modelMatrix());
 }
 
-void Car::drawLight(glm::mat4 &projView, glm::mat4 headlightModel,
-                    bool isFrontHeadlight) {
-  // Positionnement à z=0.029.
-  glm::mat4 lightModel = glm::translate(headlightModel, {0, 0, 0.029f});
-  glm::vec3 color =
-      isFrontHeadlight
-          ? (isHeadlightOn ? glm::vec3(1, 1, 1) : glm::vec3(0.5, 0.5, 0.5))
-          : (isBraking ? glm::vec3(1, 0.1, 0.1) : glm::vec3(0.5, 0.1, 0.1));
-  glUniformMatrix4fv(mvpUniformLocation, 1, GL_FALSE,
-                     glm::value_ptr(projView * lightModel));
-  setColorMod(color);
-  light_.draw();
+size_t Car::addPart(const Model &model, size_t node) {
+  parts_.push_back({&model, node, -1, {}, glm::vec3(1.0f)});
+  return parts_.size() - 1;
 }
 
-void Car::drawHeadlight(glm::mat4 &projView, glm::mat4 headlightModel,
-                        bool isFrontHeadlight, bool isLeftHeadlight) {
-  // Rotation de 5 degrés pour épouser le châssis à l'avant.
-  if (isFrontHeadlight)
-    headlightModel = glm::rotate(headlightModel, glm::radians(5.0f), {0, 0, 1});
-  drawLight(projView, headlightModel, isFrontHeadlight);
-  drawBlinker(projView, headlightModel, isLeftHeadlight);
+void Car::buildSceneGraph() {
+  sceneGraph_ = {};
+  parts_.clear();
+  carNode_ = sceneGraph_.add(SceneGraph::NO_PARENT, modelMatrix());
+
+  size_t frameNode = sceneGraph_.add(
+      carNode_, glm::translate(glm::mat4(1.0f), FRAME_POSITION));
+  addPart(*frame_, frameNode);
+
+  for (int i = 0; i < 4; ++i) {
+    Headlight &headlight = headlights_[i];
+    headlight.isFront = i < 2;
+    headlight.isLeft = i % 2 == 0;
+    glm::mat4 headlightModel =
+        glm::translate(glm::mat4(1.0f), HEADLIGHT_POSITIONS[i]);
+    // Rotation de 5 degrés pour épouser le châssis à l'avant.
+    if (headlight.isFront)
+      headlightModel =
+          glm::rotate(headlightModel, glm::radians(5.0f), {0, 0, 1});
+    size_t headlightNode = sceneGraph_.add(frameNode, headlightModel);
+
+    // Lumière à z=LIGHT_OFFSET, clignotant à z=BLINKER_OFFSET du côté
+    // extérieur.
+    headlight.lightPart = addPart(
+        *light_,
+        sceneGraph_.add(headlightNode, glm::translate(glm::mat4(1.0f),
+                                                      {0, 0, LIGHT_OFFSET})));
+    float blinkerOffset = headlight.isLeft ? -BLINKER_OFFSET : BLINKER_OFFSET;
+    headlight.blinkerPart = addPart(
+        *blinker_,
+        sceneGraph_.add(headlightNode, glm::translate(glm::mat4(1.0f),
+                                                      {0, 0, blinkerOffset})));
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    glm::mat4 mount = glm::translate(glm::mat4(1.0f), WHEEL_POSITIONS[i]);
+    // Rotation pour que la jante soit vers l'extérieur pour les roues de
+    // droite.
+    if (WHEEL_POSITIONS[i].z >= 0)
+      mount = glm::rotate(mount, glm::pi<float>(), {0, 1, 0});
+    // Changement de l'axe de rotation (WHEEL_PIVOT_OFFSET vers l'intérieur).
+    mount = glm::translate(mount, {0, 0, WHEEL_PIVOT_OFFSET});
+    size_t mountNode = sceneGraph_.add(carNode_, mount);
+    wheelSpinNodes_[i] = sceneGraph_.add(mountNode, wheelSpin(i));
+    addPart(*wheel_, wheelSpinNodes_[i]);
+  }
 }
 
-void Car::drawHeadlights(glm::mat4 &projView, glm::mat4 frameModel) {
-  const glm::vec3 HEADLIGHT_POSITIONS[] = {
-      glm::vec3(-1.9650f, 0.38f, -0.45f), glm::vec3(-1.9650f, 0.38f, 0.45f),
-      glm::vec3(2.0019f, 0.38f, -0.45f), glm::vec3(2.0019f, 0.38f, 0.45f)};
-  for (int i = 0; i < 4; ++i)
-    drawHeadlight(projView, glm::translate(frameModel, HEADLIGHT_POSITIONS[i]),
-                  i < 2, i % 2 == 0);
+void Car::updateColorMods() {
+  for (const Headlight &headlight : headlights_) {
+    parts_[headlight.lightPart].colorMod =
+        headlight.isFront
+            ? (isHeadlightOn ? glm::vec3(1, 1, 1) : glm::vec3(0.5, 0.5, 0.5))
+            : (isBraking ? glm::vec3(1, 0.1, 0.1) : glm::vec3(0.5, 0.1, 0.1));
+
+    bool isBlinkerActivated = headlight.isLeft ? isLeftBlinkerActivated
+                                               : isRightBlinkerActivated;
+    parts_[headlight.blinkerPart].colorMod =
+        isBlinkerOn && isBlinkerActivated ? glm::vec3(1.0f, 0.7f, 0.3f)
+                                          : glm::vec3(0.5f, 0.35f, 0.15f);
+  }
 }
@@ -2,20 +2,41 @@
 
 #include <glbinding/gl/gl.h>
 #include <glm/glm.hpp>
+#include <memory>
+#include <vector>
 
 #include "model.hpp"
+#include "model_loader.hpp"
+#include "model_registry.hpp"
+#include "object_buffer.hpp"
+#include "render_queue.hpp"
+#include "scene_graph.hpp"
 
 class Car {
 public:
   Car();
 
-  void loadModels();
+  // Les modèles sont partagés entre toutes les voitures par le registre; ils
+  // sont prêts après loader.finish().
+  void loadModels(ModelRegistry &registry, ModelLoader &loader);
+
+  // Modèles des pièces, chargés par loadModels().
+  std::vector<const Model *> models() const;
 
   void update(float deltaTime);
 
-  void draw(glm::mat4 &projView);
+  // Calcule la matrice de chaque pièce et l'ajoute à objects. À appeler à
+  // chaque trame avant le transfert de objects et avant submitDraw().
+  void prepareDraw(ObjectBuffer &objects);
+
+  // Soumet à queue le dessin des pièces préparées par prepareDraw(), avec
+  // le programme program.
+  void submitDraw(RenderQueue &queue, gl::GLuint program,
+                  const glm::mat4 &projView) const;
 
-  void setColorMod(const glm::vec3 &color);
+  // Volumes englobants de toute la voiture dans le monde, à sa position
+  // actuelle.
+  Bounds worldBounds() const;
 
 public:
   glm::vec3 position;
@@ -32,28 +53,48 @@ public:
   bool isBlinkerOn;
   float blinkerTimer;
 
-  gl::GLint colorModUniformLocation;
-  gl::GLint mvpUniformLocation;
-
 private:
-  void drawFrame(glm::mat4 &projView, glm::mat4 carModel);
-
-  void drawWheel(glm::mat4 &projView, glm::mat4 wheelModel, bool isFrontWheel);
-  void drawWheels(glm::mat4 &projView, glm::mat4 carModel);
-
-  void drawBlinker(glm::mat4 &projView, glm::mat4 headlightModel,
-                   bool isLeftHeadlight);
-  void drawLight(glm::mat4 &projView, glm::mat4 headlightModel,
-                 bool isFrontHeadlight);
-  void drawHeadlight(glm::mat4 &projView, glm::mat4 headlightModel,
-                     bool isFrontHeadlight, bool isLeftHeadlight);
-  void drawHeadlights(glm::mat4 &projView, glm::mat4 frameModel);
+  // Pièce à dessiner: modèle, nœud du graphe de scène qui la place, numéro
+  // de sa matrice dans le tampon d'objets, volumes englobants dans le monde
+  // et modulation de couleur.
+  struct Part {
+    const Model *model;
+    size_t node;
+    gl::GLint object;
+    Bounds worldBounds;
+    glm::vec3 colorMod;
+  };
+
+  // Pièces d'un phare: la lumière et le clignotant.
+  struct Headlight {
+    size_t lightPart;
+    size_t blinkerPart;
+    bool isFront;
+    bool isLeft;
+  };
+
+  glm::mat4 modelMatrix() const;
+
+  // Braquage et rotation de la roue i autour de son axe.
+  glm::mat4 wheelSpin(int i) const;
+
+  size_t addPart(const Model &model, size_t node);
+
+  // Construit la hiérarchie des pièces; seuls la voiture et la rotation des
+  // roues changent ensuite.
+  void buildSceneGraph();
+
+  void updateColorMods();
 
 private:
-  Model frame_;
-  Model wheel_;
-  Model blinker_;
-  Model light_;
-
-  glm::vec3 lastColorMod_;
+  std::shared_ptr<Model> frame_;
+  std::shared_ptr<Model> wheel_;
+  std::shared_ptr<Model> blinker_;
+  std::shared_ptr<Model> light_;
+
+  SceneGraph sceneGraph_;
+  size_t carNode_;
+  size_t wheelSpinNodes_[4];
+  Headlight headlights_[4];
+  std::vector<Part> parts_;
 };
@@ -0,0 +1,154 @@
+#include "frustum_culling.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULLING_USE_AVX
+#elif defined(__SSE__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CULLING_USE_SSE
+#endif
+
+namespace {
+
+// Nombre de boîtes testées à la fois; les tableaux sont complétés jusqu'à un
+// multiple de cette taille.
+constexpr size_t BATCH_SIZE = 8;
+
+// Plan prêt pour le test des boîtes: normale, valeur absolue de la normale et
+// distance.
+struct CullingPlane {
+  glm::vec3 normal;
+  glm::vec3 absNormal;
+  float d;
+};
+
+void preparePlanes(const Frustum &frustum, CullingPlane planes[6]) {
+  for (int i = 0; i < 6; ++i) {
+    const glm::vec4 &p = frustum.planes[i];
+    planes[i] = {glm::vec3(p), glm::abs(glm::vec3(p)), p.w};
+  }
+}
+
+} // namespace
+
+Frustum::Frustum(const glm::mat4 &projView) {
+  // Méthode de Gribb et Hartmann: chaque plan est une somme ou une différence
+  // de la dernière rangée de la matrice avec une des trois autres.
+  glm::mat4 rows = glm::transpose(projView);
+  for (int axis = 0; axis < 3; ++axis) {
+    planes[2 * axis] = rows[3] + rows[axis];
+    planes[2 * axis + 1] = rows[3] - rows[axis];
+  }
+}
+
+size_t CullingSet::add(const BoundingBox &box) {
+  if (size_ == centerX_.size()) {
+    size_t padded = centerX_.size() + BATCH_SIZE;
+    for (std::vector<float> *array :
+         {&centerX_, &centerY_, &centerZ_, &extentX_, &extentY_, &extentZ_})
+      array->resize(padded, 0.0f);
+  }
+  set(size_, box);
+  return size_++;
+}
+
+void CullingSet::set(size_t index, const BoundingBox &box) {
+  glm::vec3 center = box.center(), extents = box.extents();
+  centerX_[index] = center.x;
+  centerY_[index] = center.y;
+  centerZ_[index] = center.z;
+  extentX_[index] = extents.x;
+  extentY_[index] = extents.y;
+  extentZ_[index] = extents.z;
+}
+
+void CullingSet::clear() {
+  for (std::vector<float> *array :
+       {&centerX_, &centerY_, &centerZ_, &extentX_, &extentY_, &extentZ_})
+    array->clear();
+  size_ = 0;
+}
+
+size_t CullingSet::cull(const Frustum &frustum,
+                        std::vector<uint8_t> &visible) const {
+  // Une boîte est hors de la pyramide si elle est entièrement du côté
+  // extérieur d'un des plans: la distance signée de son centre, plus son
+  // rayon projeté sur la normale, y est négative.
+  CullingPlane planes[6];
+  preparePlanes(frustum, planes);
+  visible.resize(centerX_.size());
+
+#if defined(CULLING_USE_AVX)
+  for (size_t first = 0; first < size_; first += 8) {
+    __m256 cx = _mm256_loadu_ps(&centerX_[first]);
+    __m256 cy = _mm256_loadu_ps(&centerY_[first]);
+    __m256 cz = _mm256_loadu_ps(&centerZ_[first]);
+    __m256 ex = _mm256_loadu_ps(&extentX_[first]);
+    __m256 ey = _mm256_loadu_ps(&extentY_[first]);
+    __m256 ez = _mm256_loadu_ps(&extentZ_[first]);
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (const CullingPlane &p : planes) {
+      __m256 distance = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(p.normal.x)),
+                        _mm256_mul_ps(cy, _mm256_set1_ps(p.normal.y))),
+          _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(p.normal.z)),
+                        _mm256_set1_ps(p.d)));
+      __m256 radius = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(p.absNormal.x)),
+                        _mm256_mul_ps(ey, _mm256_set1_ps(p.absNormal.y))),
+          _mm256_mul_ps(ez, _mm256_set1_ps(p.absNormal.z)));
+      inside = _mm256_and_ps(inside,
+                             _mm256_cmp_ps(_mm256_add_ps(distance, radius),
+                                           _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    int mask = _mm256_movemask_ps(inside);
+    for (int lane = 0; lane < 8; ++lane)
+      visible[first + lane] = (mask >> lane) & 1;
+  }
+#elif defined(CULLING_USE_SSE)
+  for (size_t first = 0; first < size_; first += 4) {
+    __m128 cx = _mm_loadu_ps(&centerX_[first]);
+    __m128 cy = _mm_loadu_ps(&centerY_[first]);
+    __m128 cz = _mm_loadu_ps(&centerZ_[first]);
+    __m128 ex = _mm_loadu_ps(&extentX_[first]);
+    __m128 ey = _mm_loadu_ps(&extentY_[first]);
+    __m128 ez = _mm_loadu_ps(&extentZ_[first]);
+    __m128 inside = _mm_cmpeq_ps(cx, cx);
+    for (const CullingPlane &p : planes) {
+      __m128 distance =
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(p.normal.x)),
+                                _mm_mul_ps(cy, _mm_set1_ps(p.normal.y))),
+                     _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(p.normal.z)),
+                                _mm_set1_ps(p.d)));
+      __m128 radius =
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(p.absNormal.x)),
+                                _mm_mul_ps(ey, _mm_set1_ps(p.absNormal.y))),
+                     _mm_mul_ps(ez, _mm_set1_ps(p.absNormal.z)));
+      inside = _mm_and_ps(
+          inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+    }
+    int mask = _mm_movemask_ps(inside);
+    for (int lane = 0; lane < 4; ++lane)
+      visible[first + lane] = (mask >> lane) & 1;
+  }
+#else
+  for (size_t i = 0; i < size_; ++i) {
+    glm::vec3 center(centerX_[i], centerY_[i], centerZ_[i]);
+    glm::vec3 extents(extentX_[i], extentY_[i], extentZ_[i]);
+    bool inside = true;
+    for (const CullingPlane &p : planes) {
+      float distance = glm::dot(center, p.normal) + p.d;
+      float radius = glm::dot(extents, p.absNormal);
+      inside = inside && distance + radius >= 0.0f;
+    }
+    visible[i] = inside;
+  }
+#endif
+
+  visible.resize(size_);
+  size_t nVisible = 0;
+  for (size_t i = 0; i < size_; ++i)
+    nVisible += visible[i];
+  return nVisible;
+}
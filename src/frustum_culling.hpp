@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+
+// Les six plans d'une pyramide de vue, orientés vers l'intérieur.
+struct Frustum {
+  // Plans (normale, distance) extraits d'une matrice de projection-vue: un
+  // point p est du côté intérieur d'un plan si dot(xyz, p) + w >= 0.
+  explicit Frustum(const glm::mat4 &projView);
+
+  glm::vec4 planes[6];
+};
+
+// Ensemble de boîtes englobantes, dans l'espace du monde, testées par lots
+// contre une pyramide de vue.
+//
+// Les boîtes sont rangées en structure de tableaux (centres et demi-tailles
+// par composante) pour être testées 8 à la fois avec AVX ou 4 à la fois avec
+// SSE, selon les instructions permises à la compilation; un test scalaire
+// sert sur les autres processeurs.
+class CullingSet {
+public:
+  // Ajoute une boîte et retourne son numéro.
+  size_t add(const BoundingBox &box);
+
+  // Remplace la boîte numéro index, pour les objets qui se déplacent.
+  void set(size_t index, const BoundingBox &box);
+
+  void clear();
+
+  size_t size() const { return size_; }
+
+  // Met visible[i] à 1 si la boîte i touche la pyramide de vue, à 0 sinon,
+  // et retourne le nombre de boîtes visibles. Le test est prudent: une boîte
+  // près d'un coin de la pyramide peut être gardée à tort, jamais rejetée à
+  // tort.
+  size_t cull(const Frustum &frustum, std::vector<uint8_t> &visible) const;
+
+private:
+  // Les tableaux sont complétés jusqu'à un multiple de la largeur des lots
+  // par des boîtes vides placées à l'origine.
+  std::vector<float> centerX_, centerY_, centerZ_;
+  std::vector<float> extentX_, extentY_, extentZ_;
+  size_t size_ = 0;
+};
@@ -0,0 +1,201 @@
+#include "gl_state.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+using namespace gl;
+
+namespace {
+
+// Valeur d'un uniforme, comparée octet par octet.
+struct UniformValue {
+  uint32_t words[4];
+  size_t size;
+
+  bool operator==(const UniformValue &other) const {
+    return size == other.size && std::memcmp(words, other.words, size) == 0;
+  }
+};
+
+template <typename T> UniformValue uniformValue(const T &value) {
+  static_assert(sizeof(T) <= sizeof(UniformValue::words));
+  UniformValue result = {};
+  std::memcpy(result.words, &value, sizeof(T));
+  result.size = sizeof(T);
+  return result;
+}
+
+uint64_t pairKey(uint32_t first, uint32_t second) {
+  return (uint64_t(first) << 32) | second;
+}
+
+// Tampon lié à un point indexé, en entier (size = -1) ou en partie.
+struct BufferRange {
+  GLuint buffer;
+  GLintptr offset;
+  GLsizeiptr size;
+
+  bool operator==(const BufferRange &other) const {
+    return buffer == other.buffer && offset == other.offset &&
+           size == other.size;
+  }
+};
+
+struct State {
+  // Les valeurs inconnues sont absentes des tables.
+  bool isProgramKnown = false, isVaoKnown = false;
+  GLuint program = 0, vao = 0;
+  GLuint activeUnit = ~0u;
+  std::unordered_map<uint32_t, GLuint> buffers;
+  std::unordered_map<uint64_t, BufferRange> bufferRanges;
+  std::unordered_map<uint64_t, GLuint> textures;
+  std::unordered_map<uint32_t, bool> capabilities;
+  std::unordered_map<uint64_t, UniformValue> uniforms;
+
+  GlStateCache::Stats frame, lastFrame;
+} state;
+
+uint32_t enumKey(GLenum value) { return static_cast<uint32_t>(value); }
+
+// Retient value dans known et retourne true si l'appel OpenGL est à faire.
+template <typename Map, typename Key, typename Value>
+bool update(Map &known, const Key &key, const Value &value) {
+  auto [it, isNew] = known.try_emplace(key, value);
+  if (!isNew && it->second == value) {
+    ++state.frame.skipped;
+    return false;
+  }
+  it->second = value;
+  ++state.frame.issued;
+  return true;
+}
+
+bool update(bool &isKnown, GLuint &known, GLuint value) {
+  if (isKnown && known == value) {
+    ++state.frame.skipped;
+    return false;
+  }
+  isKnown = true;
+  known = value;
+  ++state.frame.issued;
+  return true;
+}
+
+template <typename T> bool updateUniform(GLint location, const T &value) {
+  // GL ignore l'emplacement -1 (uniforme absent ou éliminé). Sans programme
+  // connu, la valeur ne peut pas être retenue.
+  if (location == -1)
+    return false;
+  if (!state.isProgramKnown) {
+    ++state.frame.issued;
+    return true;
+  }
+  return update(state.uniforms,
+                pairKey(state.program, static_cast<uint32_t>(location)),
+                uniformValue(value));
+}
+
+} // namespace
+
+bool isGlVersionAtLeast(int major, int minor) {
+  GLint contextMajor = 0, contextMinor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+  glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+  return contextMajor > major ||
+         (contextMajor == major && contextMinor >= minor);
+}
+
+void GlStateCache::beginFrame() {
+  state.lastFrame = state.frame;
+  state.frame = {};
+  invalidate();
+}
+
+GlStateCache::Stats GlStateCache::lastFrameStats() { return state.lastFrame; }
+
+void GlStateCache::invalidate() {
+  state.isProgramKnown = state.isVaoKnown = false;
+  state.activeUnit = ~0u;
+  state.buffers.clear();
+  state.bufferRanges.clear();
+  state.textures.clear();
+  state.capabilities.clear();
+}
+
+void GlStateCache::forgetProgram(GLuint program) {
+  std::erase_if(state.uniforms, [program](const auto &entry) {
+    return static_cast<GLuint>(entry.first >> 32) == program;
+  });
+  if (state.program == program)
+    state.isProgramKnown = false;
+}
+
+void GlStateCache::useProgram(GLuint program) {
+  if (update(state.isProgramKnown, state.program, program))
+    glUseProgram(program);
+}
+
+void GlStateCache::bindVertexArray(GLuint vao) {
+  if (update(state.isVaoKnown, state.vao, vao))
+    glBindVertexArray(vao);
+}
+
+void GlStateCache::bindBuffer(GLenum target, GLuint buffer) {
+  if (target == GL_ELEMENT_ARRAY_BUFFER) {
+    ++state.frame.issued;
+    glBindBuffer(target, buffer);
+    return;
+  }
+  if (update(state.buffers, enumKey(target), buffer))
+    glBindBuffer(target, buffer);
+}
+
+void GlStateCache::bindBufferBase(GLenum target, GLuint index,
+                                  GLuint buffer) {
+  if (!update(state.bufferRanges, pairKey(enumKey(target), index),
+              BufferRange{buffer, 0, -1}))
+    return;
+  glBindBufferBase(target, index, buffer);
+  // glBindBufferBase lie aussi le tampon à la cible générale.
+  state.buffers[enumKey(target)] = buffer;
+}
+
+void GlStateCache::bindBufferRange(GLenum target, GLuint index,
+                                   GLuint buffer, GLintptr offset,
+                                   GLsizeiptr size) {
+  if (!update(state.bufferRanges, pairKey(enumKey(target), index),
+              BufferRange{buffer, offset, size}))
+    return;
+  glBindBufferRange(target, index, buffer, offset, size);
+  state.buffers[enumKey(target)] = buffer;
+}
+
+void GlStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+  if (!update(state.textures, pairKey(unit, enumKey(target)), texture))
+    return;
+  if (state.activeUnit != unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    state.activeUnit = unit;
+  }
+  glBindTexture(target, texture);
+}
+
+void GlStateCache::setEnabled(GLenum capability, bool isEnabled) {
+  if (!update(state.capabilities, enumKey(capability), isEnabled))
+    return;
+  if (isEnabled)
+    glEnable(capability);
+  else
+    glDisable(capability);
+}
+
+void GlStateCache::uniform(GLint location, GLint value) {
+  if (updateUniform(location, value))
+    glUniform1i(location, value);
+}
+
+void GlStateCache::uniform(GLint location, const glm::vec3 &value) {
+  if (updateUniform(location, value))
+    glUniform3fv(location, 1, &value[0]);
+}
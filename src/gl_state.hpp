@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glbinding/gl/gl.h>
+#include <glm/glm.hpp>
+
+// Vrai si le contexte actuel est d'OpenGL major.minor ou plus.
+bool isGlVersionAtLeast(int major, int minor);
+
+// Copie de l'état OpenGL modifié par le rendu, qui évite les appels qui ne
+// changent rien.
+//
+// Le programme, le VAO, les tampons liés aux cibles générales, les textures
+// par unité, les capacités (glEnable/glDisable) et les valeurs des uniformes
+// de chaque programme sont retenus. Le rendu doit passer par ces fonctions
+// plutôt que par les appels OpenGL correspondants pour que la copie reste
+// exacte. Le tampon d'éléments fait partie de l'état du VAO et n'est pas
+// retenu.
+//
+// Les liaisons et les capacités sont oubliées au début de chaque trame, le
+// code extérieur (ex. ImGui) pouvant les changer entre deux trames. Les
+// uniformes appartiennent à leur programme, que le code extérieur ne touche
+// pas: ils sont gardés d'une trame à l'autre, jusqu'à ce que le programme
+// soit lié de nouveau ou supprimé (voir forgetProgram()).
+class GlStateCache {
+public:
+  // Nombre d'appels envoyés à OpenGL et évités pendant une trame.
+  struct Stats {
+    unsigned int issued = 0;
+    unsigned int skipped = 0;
+  };
+
+  // Oublie les liaisons et les capacités retenues et recommence le compte
+  // des appels.
+  static void beginFrame();
+
+  // Appels de la trame précédente.
+  static Stats lastFrameStats();
+
+  // Oublie les liaisons et les capacités retenues, après des appels OpenGL
+  // faits directement.
+  static void invalidate();
+
+  // Oublie les uniformes retenus de program. À appeler après chaque
+  // glLinkProgram, qui remet ses uniformes à zéro, et avant glDeleteProgram,
+  // le nom pouvant être réutilisé.
+  static void forgetProgram(gl::GLuint program);
+
+  static void useProgram(gl::GLuint program);
+
+  static void bindVertexArray(gl::GLuint vao);
+
+  // Le tampon d'éléments est toujours lié, comme état du VAO actuel.
+  static void bindBuffer(gl::GLenum target, gl::GLuint buffer);
+
+  static void bindBufferBase(gl::GLenum target, gl::GLuint index,
+                             gl::GLuint buffer);
+
+  static void bindBufferRange(gl::GLenum target, gl::GLuint index,
+                              gl::GLuint buffer, gl::GLintptr offset,
+                              gl::GLsizeiptr size);
+
+  static void bindTexture(gl::GLuint unit, gl::GLenum target,
+                          gl::GLuint texture);
+
+  static void setEnabled(gl::GLenum capability, bool isEnabled);
+
+  // Uniformes du programme actuel (voir useProgram()).
+  static void uniform(gl::GLint location, gl::GLint value);
+  static void uniform(gl::GLint location, const glm::vec3 &value);
+};
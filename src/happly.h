@@ -48,18 +48,40 @@ SOFTWARE.
 */
 // clang-format on
 
+#include <algorithm>
 #include <array>
 #include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <vector>
 #include <climits>
 
+// SIMD byte swapping for big endian files, selected at runtime
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define HAPPLY_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HAPPLY_TARGET(isa) __attribute__((target(isa)))
+#else
+#define HAPPLY_TARGET(isa)
+#endif
+
 // General namespace wrapping all Happly things.
 namespace happly {
 
@@ -148,6 +170,30 @@ public:
    */
   virtual void parseNext(const std::vector<std::string>& tokens, size_t& currEntry) = 0;
 
+  /**
+   * @brief (ASCII reading) Parse out the next value of this property directly from a line of text, without building
+   * string tokens. Gives the same result as the token-based parseNext().
+   *
+   * @param cursor Current position in the line, updated after this property is read.
+   * @param lineEnd End of the line.
+   */
+  virtual void parseNext(const char*& cursor, const char* lineEnd) = 0;
+
+  /**
+   * @brief Create a new, empty property with the same name and type as this one. Used to parse chunks of an element
+   * in parallel.
+   *
+   * @return The new property.
+   */
+  virtual std::unique_ptr<Property> cloneEmpty() const = 0;
+
+  /**
+   * @brief Move the entries of another property of the same type to the end of this one.
+   *
+   * @param other Property to take the entries from. Left empty.
+   */
+  virtual void append(Property& other) = 0;
+
   /**
    * @brief (binary reading) Copy the next value of this property from a stream of bits.
    *
@@ -162,6 +208,36 @@ public:
    */
   virtual void readNextBigEndian(std::istream& stream) = 0;
 
+  /**
+   * @brief (binary reading) Like readNextBigEndian(), but leaves the values in file byte order. swapEndianData() must
+   * be called once all entries are read. List counts are still converted, since they are needed to read the list.
+   *
+   * @param stream Stream to read from.
+   */
+  virtual void readNextBigEndianDeferred(std::istream& stream) = 0;
+
+  /**
+   * @brief (binary reading) Copy the values of this property for a block of consecutive fixed-size elements.
+   *
+   * @param block Raw element data, as read from the file.
+   * @param count Number of elements in the block.
+   * @param stride Size in bytes of one element.
+   * @param offset Offset in bytes of this property inside an element.
+   */
+  virtual void readBlock(const char* block, size_t count, size_t stride, size_t offset) = 0;
+
+  /**
+   * @brief Swap the byte order of all of the values of this property, in place.
+   */
+  virtual void swapEndianData() = 0;
+
+  /**
+   * @brief Size in bytes of this property inside an element, or 0 for lists which have a variable size.
+   *
+   * @return
+   */
+  virtual size_t fixedSize() = 0;
+
   /**
    * @brief (reading) Write a header entry for this property.
    *
@@ -242,6 +318,115 @@ T swapEndian(T val) {
 template <> int8_t swapEndian<int8_t>(int8_t val) { return val; }
 template <> uint8_t swapEndian<uint8_t>(uint8_t val) { return val; }
 
+#ifdef HAPPLY_X86
+
+/**
+ * Check whether the CPU supports SSSE3 (needed for byte shuffles).
+ */
+inline bool cpuHasSSSE3() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+/**
+ * Check whether the CPU and OS support AVX2.
+ */
+inline bool cpuHasAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 1);
+  bool osSavesAVX = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+  if (!osSavesAVX) return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+/**
+ * Shuffle mask reversing the bytes of each N-byte value in a 16-byte lane.
+ */
+template <size_t N>
+HAPPLY_TARGET("ssse3") __m128i byteSwapMask() {
+  alignas(16) char maskBytes[16];
+  for (size_t j = 0; j < 16; j++) {
+    maskBytes[j] = static_cast<char>(j / N * N + (N - 1 - j % N));
+  }
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(maskBytes));
+}
+
+/**
+ * Swap the byte order of as many N-byte values as fit in whole 16-byte vectors.
+ *
+ * @return The number of values swapped.
+ */
+template <size_t N>
+HAPPLY_TARGET("ssse3") size_t swapEndianSSSE3(char* bytes, size_t count) {
+  const __m128i mask = byteSwapMask<N>();
+  const size_t perVector = 16 / N;
+  size_t i = 0;
+  for (; i + perVector <= count; i += perVector) {
+    __m128i* p = reinterpret_cast<__m128i*>(bytes + i * N);
+    _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+  }
+  return i;
+}
+
+/**
+ * Swap the byte order of as many N-byte values as fit in whole 32-byte vectors.
+ *
+ * @return The number of values swapped.
+ */
+template <size_t N>
+HAPPLY_TARGET("avx2") size_t swapEndianAVX2(char* bytes, size_t count) {
+  const __m256i mask = _mm256_broadcastsi128_si256(byteSwapMask<N>());
+  const size_t perVector = 32 / N;
+  size_t i = 0;
+  for (; i + perVector <= count; i += perVector) {
+    __m256i* p = reinterpret_cast<__m256i*>(bytes + i * N);
+    _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+  }
+  return i;
+}
+
+#endif
+
+/**
+ * Swap endianness of a whole array of values, in place. Uses AVX2 or SSSE3 byte shuffles when the CPU supports them,
+ * and the scalar swapEndian() for the remainder.
+ *
+ * @param values Values to swap.
+ * @param count Number of values.
+ */
+template <typename T>
+void swapEndianInPlace(T* values, size_t count) {
+  if constexpr (sizeof(T) == 1) return;
+
+  size_t i = 0;
+#ifdef HAPPLY_X86
+  static const bool hasAVX2 = cpuHasAVX2();
+  static const bool hasSSSE3 = cpuHasSSSE3();
+  char* bytes = reinterpret_cast<char*>(values);
+  if (hasAVX2) {
+    i = swapEndianAVX2<sizeof(T)>(bytes, count);
+  }
+  if (hasSSSE3) {
+    i += swapEndianSSSE3<sizeof(T)>(bytes + i * sizeof(T), count - i);
+  }
+#endif
+  for (; i < count; i++) {
+    values[i] = swapEndian(values[i]);
+  }
+}
+
 
 // Unpack flattened list from the convention used in TypedListProperty
 template <typename T>
@@ -266,6 +451,100 @@ std::vector<std::vector<T>> unflattenList(const std::vector<T>& flatList, const
 }
 
 
+/**
+ * Find the next token of an ASCII line, splitting like tokenSplit(): tokens are separated by spaces only, trailing
+ * '\r' and '\n' are trimmed from each token, and tokens left empty are skipped.
+ *
+ * @param cursor Current position in the line, moved past the token.
+ * @param lineEnd End of the line.
+ * @param tokenBegin Output: beginning of the token (equal to tokenEnd if there are no more tokens).
+ * @param tokenEnd Output: end of the token.
+ */
+inline void nextToken(const char*& cursor, const char* lineEnd, const char*& tokenBegin, const char*& tokenEnd) {
+  do {
+    while (cursor != lineEnd && *cursor == ' ') cursor++;
+    tokenBegin = cursor;
+    while (cursor != lineEnd && *cursor != ' ') cursor++;
+    tokenEnd = cursor;
+    while (tokenEnd != tokenBegin && (tokenEnd[-1] == '\r' || tokenEnd[-1] == '\n')) tokenEnd--;
+  } while (tokenBegin == tokenEnd && cursor != lineEnd);
+}
+
+/**
+ * Parse a number from an ASCII token with std::from_chars, reproducing exactly what `std::istringstream >> T` gives:
+ * a leading '+' is accepted, negative values wrap for unsigned types, values are clamped to the range of the type on
+ * overflow, and 0 is returned for an invalid token.
+ *
+ * @param begin Beginning of the token.
+ * @param end End of the token.
+ *
+ * @return The parsed value.
+ */
+template <typename T>
+T parseASCIINumber(const char* begin, const char* end) {
+  // The stream skips leading whitespace other than spaces (which separate tokens)
+  while (begin != end && std::isspace(static_cast<unsigned char>(*begin))) begin++;
+  if (begin != end && *begin == '+') begin++;
+  bool negative = begin != end && *begin == '-';
+
+  if constexpr (std::is_floating_point<T>::value) {
+    // Stream extraction only accepts decimal notation (no inf, nan nor hexadecimal)
+    const char* digits = negative ? begin + 1 : begin;
+    if (digits == end || !(std::isdigit(static_cast<unsigned char>(*digits)) || *digits == '.')) return 0;
+
+    T value = 0;
+    std::from_chars_result result = std::from_chars(begin, end, value, std::chars_format::general);
+    if (result.ec == std::errc::result_out_of_range) {
+      // Rare: defer to strto* like the stream does, then clamp overflows to the largest finite value
+      std::string token(begin, result.ptr);
+      value = std::is_same<T, float>::value ? std::strtof(token.c_str(), nullptr) : std::strtod(token.c_str(), nullptr);
+      if (std::isinf(value)) value = negative ? -std::numeric_limits<T>::max() : std::numeric_limits<T>::max();
+    } else if (result.ec != std::errc()) {
+      return 0;
+    } else if (result.ptr != end && (*result.ptr == 'e' || *result.ptr == 'E') &&
+               std::find_if(begin, result.ptr, [](char c) { return c == 'e' || c == 'E'; }) == result.ptr) {
+      // Dangling exponent ("1e", "1.5e-"): the stream consumes it and fails, from_chars stops before it
+      return 0;
+    }
+    return value;
+  } else {
+    if constexpr (std::is_unsigned<T>::value) {
+      if (negative) {
+        T magnitude = 0;
+        std::from_chars_result result = std::from_chars(begin + 1, end, magnitude);
+        if (result.ec == std::errc::result_out_of_range) return std::numeric_limits<T>::max();
+        if (result.ec != std::errc()) return 0;
+        return static_cast<T>(0 - magnitude);
+      }
+    }
+
+    T value = 0;
+    std::from_chars_result result = std::from_chars(begin, end, value);
+    if (result.ec == std::errc::result_out_of_range) {
+      return negative ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+    }
+    if (result.ec != std::errc()) return 0;
+    return value;
+  }
+}
+
+/**
+ * Parse the next token of an ASCII line as a number.
+ *
+ * @param cursor Current position in the line, moved past the token.
+ * @param lineEnd End of the line.
+ *
+ * @return The parsed value.
+ */
+template <typename T>
+T parseNextASCIINumber(const char*& cursor, const char* lineEnd) {
+  const char* tokenBegin;
+  const char* tokenEnd;
+  nextToken(cursor, lineEnd, tokenBegin, tokenEnd);
+  return parseASCIINumber<T>(tokenBegin, tokenEnd);
+}
+
+
 }; // namespace
 
 
@@ -324,6 +603,36 @@ public:
     currEntry++;
   };
 
+  /**
+   * @brief (ASCII reading) Parse out the next value of this property directly from a line of text.
+   *
+   * @param cursor Current position in the line, updated after this property is read.
+   * @param lineEnd End of the line.
+   */
+  virtual void parseNext(const char*& cursor, const char* lineEnd) override {
+    data.emplace_back(parseNextASCIINumber<typename SerializeType<T>::type>(cursor, lineEnd));
+  }
+
+  /**
+   * @brief Create a new, empty property with the same name and type.
+   *
+   * @return The new property.
+   */
+  virtual std::unique_ptr<Property> cloneEmpty() const override {
+    return std::unique_ptr<Property>(new TypedProperty<T>(name));
+  }
+
+  /**
+   * @brief Move the entries of another property of the same type to the end of this one.
+   *
+   * @param other Property to take the entries from. Left empty.
+   */
+  virtual void append(Property& other) override {
+    TypedProperty<T>& typedOther = dynamic_cast<TypedProperty<T>&>(other);
+    data.insert(data.end(), typedOther.data.begin(), typedOther.data.end());
+    typedOther.data.clear();
+  }
+
   /**
    * @brief (binary reading) Copy the next value of this property from a stream of bits.
    *
@@ -345,6 +654,42 @@ public:
     data.back() = swapEndian(data.back());
   }
 
+  /**
+   * @brief (binary reading) Copy the next value of this property from a stream of bits, leaving it in file byte order.
+   *
+   * @param stream Stream to read from.
+   */
+  virtual void readNextBigEndianDeferred(std::istream& stream) override { readNext(stream); }
+
+  /**
+   * @brief (binary reading) Copy the values of this property for a block of consecutive fixed-size elements.
+   *
+   * @param block Raw element data, as read from the file.
+   * @param count Number of elements in the block.
+   * @param stride Size in bytes of one element.
+   * @param offset Offset in bytes of this property inside an element.
+   */
+  virtual void readBlock(const char* block, size_t count, size_t stride, size_t offset) override {
+    size_t currSize = data.size();
+    data.resize(currSize + count);
+    const char* src = block + offset;
+    for (size_t i = 0; i < count; i++) {
+      std::memcpy(&data[currSize + i], src + i * stride, sizeof(T));
+    }
+  }
+
+  /**
+   * @brief Swap the byte order of all of the values of this property, in place.
+   */
+  virtual void swapEndianData() override { swapEndianInPlace(data.data(), data.size()); }
+
+  /**
+   * @brief Size in bytes of this property inside an element.
+   *
+   * @return
+   */
+  virtual size_t fixedSize() override { return sizeof(T); }
+
   /**
    * @brief (reading) Write a header entry for this property.
    *
@@ -487,6 +832,54 @@ public:
     flattenedIndexStart.emplace_back(afterSize);
   }
 
+  /**
+   * @brief (ASCII reading) Parse out the next value of this property directly from a line of text.
+   *
+   * @param cursor Current position in the line, updated after this property is read.
+   * @param lineEnd End of the line.
+   */
+  virtual void parseNext(const char*& cursor, const char* lineEnd) override {
+
+    size_t count = parseNextASCIINumber<size_t>(cursor, lineEnd);
+
+    size_t currSize = flattenedData.size();
+    size_t afterSize = currSize + count;
+    flattenedData.resize(afterSize);
+    for (size_t iFlat = currSize; iFlat < afterSize; iFlat++) {
+      flattenedData[iFlat] = parseNextASCIINumber<typename SerializeType<T>::type>(cursor, lineEnd);
+    }
+    flattenedIndexStart.emplace_back(afterSize);
+  }
+
+  /**
+   * @brief Create a new, empty property with the same name and type.
+   *
+   * @return The new property.
+   */
+  virtual std::unique_ptr<Property> cloneEmpty() const override {
+    return std::unique_ptr<Property>(new TypedListProperty<T>(name, listCountBytes));
+  }
+
+  /**
+   * @brief Move the entries of another property of the same type to the end of this one.
+   *
+   * @param other Property to take the entries from. Left empty.
+   */
+  virtual void append(Property& other) override {
+    TypedListProperty<T>& typedOther = dynamic_cast<TypedListProperty<T>&>(other);
+
+    // The other list starts are relative to its own data, shift them after ours
+    size_t offset = flattenedData.size();
+    flattenedData.insert(flattenedData.end(), typedOther.flattenedData.begin(), typedOther.flattenedData.end());
+    flattenedIndexStart.reserve(flattenedIndexStart.size() + typedOther.flattenedIndexStart.size() - 1);
+    for (size_t i = 1; i < typedOther.flattenedIndexStart.size(); i++) {
+      flattenedIndexStart.push_back(offset + typedOther.flattenedIndexStart[i]);
+    }
+
+    typedOther.flattenedData.clear();
+    typedOther.flattenedIndexStart.assign(1, 0);
+  }
+
   /**
    * @brief (binary reading) Copy the next value of this property from a stream of bits.
    *
@@ -536,11 +929,57 @@ public:
     flattenedIndexStart.emplace_back(afterSize);
 
     // Swap endian order of list elements
-    for (size_t iFlat = currSize; iFlat < afterSize; iFlat++) {
-      flattenedData[iFlat] = swapEndian(flattenedData[iFlat]);
+    swapEndianInPlace(flattenedData.data() + currSize, count);
+  }
+
+  /**
+   * @brief (binary reading) Copy the next value of this property from a stream of bits. The count is converted, but
+   * the list elements are left in file byte order.
+   *
+   * @param stream Stream to read from.
+   */
+  virtual void readNextBigEndianDeferred(std::istream& stream) override {
+
+    // Read the size of the list
+    size_t count = 0;
+    stream.read(((char*)&count), listCountBytes);
+    if (listCountBytes == 8) {
+      count = (size_t)swapEndian((uint64_t)count);
+    } else if (listCountBytes == 4) {
+      count = (size_t)swapEndian((uint32_t)count);
+    } else if (listCountBytes == 2) {
+      count = (size_t)swapEndian((uint16_t)count);
+    }
+
+    // Read list elements
+    size_t currSize = flattenedData.size();
+    size_t afterSize = currSize + count;
+    flattenedData.resize(afterSize);
+    if (count > 0) {
+      stream.read((char*)&flattenedData[currSize], count * sizeof(T));
     }
+    flattenedIndexStart.emplace_back(afterSize);
   }
 
+  /**
+   * @brief List properties have a variable size and cannot be read by blocks.
+   */
+  virtual void readBlock(const char*, size_t, size_t, size_t) override {
+    throw std::runtime_error("PLY parser: list property " + name + " cannot be read as a fixed-size block");
+  }
+
+  /**
+   * @brief Swap the byte order of all of the list elements of this property, in place.
+   */
+  virtual void swapEndianData() override { swapEndianInPlace(flattenedData.data(), flattenedData.size()); }
+
+  /**
+   * @brief Lists have a variable size.
+   *
+   * @return 0
+   */
+  virtual size_t fixedSize() override { return 0; }
+
   /**
    * @brief (reading) Write a header entry for this property. Note that we already use "uchar" for the list count type.
    *
@@ -1048,6 +1487,68 @@ public:
   }
 
 
+  /**
+   * @brief Get the data from a list property for this element in flattened form, as it is stored internally. This
+   * avoids the per-list allocation done by getListProperty(). Automatically promotes to larger types. Throws if
+   * requested data is unavailable.
+   *
+   * @tparam T The type of data requested
+   * @param propertyName The name of the property to get.
+   * @param listStarts Output: the i'th entry is the index in the returned data where the i'th list begins. A final
+   * entry holds the total length. Size is N_elem + 1.
+   *
+   * @return The concatenated data of all lists.
+   */
+  template <class T>
+  std::vector<T> getListPropertyFlat(const std::string& propertyName, std::vector<size_t>& listStarts) {
+
+    // Find the property
+    std::unique_ptr<Property>& prop = getPropertyPtr(propertyName);
+
+    // Get a copy of the data with auto-promoting type magic
+    return getDataFromListPropertyFlatRecursive<T, T>(prop.get(), listStarts);
+  }
+
+
+  /**
+   * @brief Same as getListPropertyFlat(), but will additionally convert between types of different sign, like
+   * getListPropertyAnySign().
+   *
+   * @tparam T The type of data requested
+   * @param propertyName The name of the property to get.
+   * @param listStarts Output: start of each list in the returned data, plus a final entry holding the total length.
+   *
+   * @return The concatenated data of all lists.
+   */
+  template <class T>
+  std::vector<T> getListPropertyFlatAnySign(const std::string& propertyName, std::vector<size_t>& listStarts) {
+
+    // Find the property
+    std::unique_ptr<Property>& prop = getPropertyPtr(propertyName);
+
+    try {
+      // First, try the usual approach, looking for a version of the property with the same signed-ness and possibly
+      // smaller size
+      return getDataFromListPropertyFlatRecursive<T, T>(prop.get(), listStarts);
+    } catch (const std::runtime_error& orig_e) {
+
+      // If the usual approach fails, look for a version with opposite signed-ness
+      try {
+
+        // This type has the oppopsite signeness as the input type
+        typedef typename CanonicalName<T>::type Tcan;
+        typedef typename std::conditional<std::is_signed<Tcan>::value, typename std::make_unsigned<Tcan>::type,
+                                          typename std::make_signed<Tcan>::type>::type OppsignType;
+
+        return getDataFromListPropertyFlatRecursive<T, OppsignType>(prop.get(), listStarts);
+
+      } catch (const std::runtime_error&) {
+        throw orig_e;
+      }
+    }
+  }
+
+
   /**
    * @brief Performs sanity checks on the element, throwing if any fail.
    */
@@ -1228,6 +1729,40 @@ public:
                                prop->propertyTypeName());
     }
   }
+
+
+  /**
+   * @brief Same as getDataFromListPropertyRecursive(), but returns the data in flattened form along with the list
+   * start offsets instead of unflattening it.
+   *
+   * @tparam D The desired output type
+   * @tparam T The current attempt for the actual type of the property
+   * @param prop The property to get (does not delete nor share pointer)
+   * @param listStarts Output: start of each list in the returned data, plus a final entry holding the total length.
+   *
+   * @return The data, with the requested type
+   */
+  template <class D, class T>
+  std::vector<D> getDataFromListPropertyFlatRecursive(Property* prop, std::vector<size_t>& listStarts) {
+    typedef typename CanonicalName<T>::type Tcan;
+
+    TypedListProperty<Tcan>* castedProp = dynamic_cast<TypedListProperty<Tcan>*>(prop);
+    if (castedProp) {
+      // Succeeded, return a single buffer of the data (copy while converting type)
+      listStarts = castedProp->flattenedIndexStart;
+      return std::vector<D>(castedProp->flattenedData.begin(), castedProp->flattenedData.end());
+    }
+
+    TypeChain<Tcan> chainType;
+    if (chainType.hasChildType) {
+      return getDataFromListPropertyFlatRecursive<D, typename TypeChain<Tcan>::type>(prop, listStarts);
+    } else {
+      // No smaller type to try, failure
+      throw std::runtime_error("PLY parser: list property " + prop->name +
+                               " cannot be coerced to requested type list " + typeName<D>() + ". Has type list " +
+                               prop->propertyTypeName());
+    }
+  }
 };
 
 
@@ -1510,6 +2045,31 @@ public:
   }
 
 
+  /**
+   * @brief Common-case helper to get face indices for a mesh in flattened form, without one allocation per face.
+   * Converts to the requested signedness like getFaceIndices().
+   *
+   * @param faceStarts Output: the i'th entry is the index in the returned data where the i'th face begins. A final
+   * entry holds the total length. For a pure triangle mesh, faceStarts[i] == 3 * i.
+   *
+   * @return The concatenated indices of all faces.
+   */
+  template <typename T = size_t>
+  std::vector<T> getFaceIndicesFlat(std::vector<size_t>& faceStarts) {
+
+    for (const std::string& f : std::vector<std::string>{"face"}) {
+      for (const std::string& p : std::vector<std::string>{"vertex_indices", "vertex_index"}) {
+        try {
+          return getElement(f).getListPropertyFlatAnySign<T>(p, faceStarts);
+        } catch (const std::runtime_error&) {
+          // that's fine
+        }
+      }
+    }
+    throw std::runtime_error("PLY parser: could not find face vertex indices attribute under any common name.");
+  }
+
+
   /**
    * @brief Common-case helper set mesh vertex positons. Creates vertex element, if necessary.
    *
@@ -1826,7 +2386,51 @@ private:
   }
 
   /**
-   * @brief Read the actual data for a file, in ASCII
+   * @brief Find the next line of an ASCII body. Like the serial std::getline() loop this replaces, empty lines are
+   * skipped when the element has properties.
+   *
+   * @param cursor Current position in the body, moved to the beginning of the following line.
+   * @param bodyEnd End of the body.
+   * @param skipEmpty Whether empty lines should be skipped.
+   * @param lineBegin Output: beginning of the line.
+   * @param lineEnd Output: end of the line (without the newline).
+   */
+  static void nextASCIILine(const char*& cursor, const char* bodyEnd, bool skipEmpty, const char*& lineBegin,
+                            const char*& lineEnd) {
+    do {
+      lineBegin = cursor;
+      const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', bodyEnd - cursor));
+      lineEnd = newline ? newline : bodyEnd;
+      cursor = newline ? newline + 1 : bodyEnd;
+    } while (skipEmpty && lineBegin == lineEnd && cursor != bodyEnd);
+  }
+
+  /**
+   * @brief Parse consecutive lines of an ASCII element.
+   *
+   * @param properties The properties to append the parsed values to.
+   * @param cursor Beginning of the first line.
+   * @param bodyEnd End of the body.
+   * @param lineCount Number of lines to parse.
+   */
+  static void parseASCIILines(std::vector<std::unique_ptr<Property>>& properties, const char* cursor,
+                              const char* bodyEnd, size_t lineCount) {
+    for (size_t iP = 0; iP < properties.size(); iP++) {
+      properties[iP]->reserve(lineCount);
+    }
+    for (size_t iEntry = 0; iEntry < lineCount; iEntry++) {
+      const char* lineBegin;
+      const char* lineEnd;
+      nextASCIILine(cursor, bodyEnd, !properties.empty(), lineBegin, lineEnd);
+      for (size_t iP = 0; iP < properties.size(); iP++) {
+        properties[iP]->parseNext(lineBegin, lineEnd);
+      }
+    }
+  }
+
+  /**
+   * @brief Read the actual data for a file, in ASCII. The body is split in line-aligned chunks which are parsed on all
+   * available cores, then merged in order; the result is identical to parsing it line by line.
    *
    * @param inStream
    * @param verbose
@@ -1836,6 +2440,20 @@ private:
     using std::string;
     using std::vector;
 
+    // Below this many lines per chunk, starting a thread costs more than it saves
+    const size_t minLinesPerChunk = 16384;
+    const size_t maxChunks = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    // Read the whole body at once
+    string body;
+    {
+      std::ostringstream bodyStream;
+      bodyStream << inStream.rdbuf();
+      body = bodyStream.str();
+    }
+    const char* cursor = body.data();
+    const char* bodyEnd = body.data() + body.size();
+
     // Read all elements
     for (Element& elem : elements) {
 
@@ -1843,31 +2461,101 @@ private:
         std::cout << "  - Processing element: " << elem.name << std::endl;
       }
 
-      for (size_t iP = 0; iP < elem.properties.size(); iP++) {
-        elem.properties[iP]->reserve(elem.count);
-      }
+      size_t nChunks = std::min(maxChunks, std::max<size_t>(1, elem.count / minLinesPerChunk));
+      size_t linesPerChunk = nChunks > 1 ? (elem.count + nChunks - 1) / nChunks : elem.count;
+      bool skipEmpty = !elem.properties.empty();
+
+      // Quick sequential scan to find where each chunk starts, and where the element ends
+      vector<const char*> chunkStarts;
       for (size_t iEntry = 0; iEntry < elem.count; iEntry++) {
+        if (iEntry % linesPerChunk == 0) {
+          chunkStarts.push_back(cursor);
+        }
+        const char* lineBegin;
+        const char* lineEnd;
+        nextASCIILine(cursor, bodyEnd, skipEmpty, lineBegin, lineEnd);
+      }
 
-        string line;
-        std::getline(inStream, line);
+      if (chunkStarts.size() <= 1) {
+        parseASCIILines(elem.properties, chunkStarts.empty() ? cursor : chunkStarts[0], bodyEnd, elem.count);
+        continue;
+      }
 
-        // Some .ply files seem to include empty lines before the start of property data (though this is not specified
-        // in the format description). We attempt to recover and parse such files by skipping any empty lines.
-        if (!elem.properties.empty()) { // if the element has no properties, the line _should_ be blank, presumably
-          while (line.empty()) { // skip lines until we hit something nonempty
-            std::getline(inStream, line);
-          }
+      // Parse each chunk in its own set of properties
+      vector<vector<std::unique_ptr<Property>>> chunkProperties(chunkStarts.size());
+      vector<std::exception_ptr> chunkErrors(chunkStarts.size());
+      vector<std::thread> workers;
+      for (size_t iChunk = 0; iChunk < chunkStarts.size(); iChunk++) {
+        for (std::unique_ptr<Property>& prop : elem.properties) {
+          chunkProperties[iChunk].push_back(prop->cloneEmpty());
         }
+        size_t lineCount = std::min(linesPerChunk, elem.count - iChunk * linesPerChunk);
+        workers.emplace_back([&, iChunk, lineCount]() {
+          try {
+            parseASCIILines(chunkProperties[iChunk], chunkStarts[iChunk], bodyEnd, lineCount);
+          } catch (...) {
+            chunkErrors[iChunk] = std::current_exception();
+          }
+        });
+      }
+      for (std::thread& worker : workers) {
+        worker.join();
+      }
+      for (std::exception_ptr& error : chunkErrors) {
+        if (error) std::rethrow_exception(error);
+      }
 
-        vector<string> tokens = tokenSplit(line);
-        size_t iTok = 0;
-        for (size_t iP = 0; iP < elem.properties.size(); iP++) {
-          elem.properties[iP]->parseNext(tokens, iTok);
+      // Merge the chunks, in order
+      for (size_t iP = 0; iP < elem.properties.size(); iP++) {
+        elem.properties[iP]->reserve(elem.count);
+        for (size_t iChunk = 0; iChunk < chunkStarts.size(); iChunk++) {
+          elem.properties[iP]->append(*chunkProperties[iChunk][iP]);
         }
       }
     }
   }
 
+  /**
+   * @brief Size in bytes of one instance of an element, or 0 if it contains lists and has a variable size.
+   *
+   * @param elem
+   */
+  static size_t elementStride(Element& elem) {
+    size_t stride = 0;
+    for (size_t iP = 0; iP < elem.properties.size(); iP++) {
+      size_t size = elem.properties[iP]->fixedSize();
+      if (size == 0) return 0;
+      stride += size;
+    }
+    return stride;
+  }
+
+  /**
+   * @brief Read all instances of a fixed-size element, by large blocks rather than value by value. The values are left
+   * in file byte order.
+   *
+   * @param inStream
+   * @param elem
+   * @param stride Size in bytes of one instance, as given by elementStride().
+   */
+  static void readElementBlocks(std::istream& inStream, Element& elem, size_t stride) {
+
+    // Bound the temporary buffer size for large elements
+    const size_t maxBlockBytes = 1 << 22;
+    size_t blockCount = std::max<size_t>(1, std::min(elem.count, maxBlockBytes / stride));
+    std::vector<char> block(blockCount * stride);
+
+    for (size_t iEntry = 0; iEntry < elem.count; iEntry += blockCount) {
+      size_t count = std::min(blockCount, elem.count - iEntry);
+      inStream.read(block.data(), count * stride);
+      size_t offset = 0;
+      for (size_t iP = 0; iP < elem.properties.size(); iP++) {
+        elem.properties[iP]->readBlock(block.data(), count, stride, offset);
+        offset += elem.properties[iP]->fixedSize();
+      }
+    }
+  }
+
   /**
    * @brief Read the actual data for a file, in binary.
    *
@@ -1893,6 +2581,14 @@ private:
       for (size_t iP = 0; iP < elem.properties.size(); iP++) {
         elem.properties[iP]->reserve(elem.count);
       }
+
+      // Elements without lists have a fixed size and are read by blocks
+      size_t stride = elementStride(elem);
+      if (stride > 0) {
+        readElementBlocks(inStream, elem, stride);
+        continue;
+      }
+
       for (size_t iEntry = 0; iEntry < elem.count; iEntry++) {
         for (size_t iP = 0; iP < elem.properties.size(); iP++) {
           elem.properties[iP]->readNext(inStream);
@@ -1902,7 +2598,8 @@ private:
   }
 
   /**
-   * @brief Read the actual data for a file, in binary.
+   * @brief Read the actual data for a file, in binary. The data is read in file byte order, then each property is
+   * converted as a whole with a vectorized byte swap.
    *
    * @param inStream
    * @param verbose
@@ -1926,11 +2623,22 @@ private:
       for (size_t iP = 0; iP < elem.properties.size(); iP++) {
         elem.properties[iP]->reserve(elem.count);
       }
-      for (size_t iEntry = 0; iEntry < elem.count; iEntry++) {
-        for (size_t iP = 0; iP < elem.properties.size(); iP++) {
-          elem.properties[iP]->readNextBigEndian(inStream);
+
+      // Elements without lists have a fixed size and are read by blocks
+      size_t stride = elementStride(elem);
+      if (stride > 0) {
+        readElementBlocks(inStream, elem, stride);
+      } else {
+        for (size_t iEntry = 0; iEntry < elem.count; iEntry++) {
+          for (size_t iP = 0; iP < elem.properties.size(); iP++) {
+            elem.properties[iP]->readNextBigEndianDeferred(inStream);
+          }
         }
       }
+
+      for (size_t iP = 0; iP < elem.properties.size(); iP++) {
+        elem.properties[iP]->swapEndianData();
+      }
     }
   }
 
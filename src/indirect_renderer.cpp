@@ -0,0 +1,185 @@
+#include "indirect_renderer.hpp"
+
+#include "gl_state.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+using namespace gl;
+
+namespace {
+
+// Diviseur des attributs de données de dessin, plus grand que tout nombre
+// d'instances: toutes les instances d'une commande lisent l'enregistrement
+// baseInstance.
+const GLuint DRAW_DATA_DIVISOR = 1u << 30;
+
+size_t vertexSize(VertexFormat format) {
+  return format == VertexFormat::Quantized ? sizeof(QuantizedVertex3D)
+                                           : sizeof(Vertex3D);
+}
+
+} // namespace
+
+bool IndirectRenderer::isSupported() { return isGlVersionAtLeast(4, 3); }
+
+IndirectRenderer::~IndirectRenderer() { release(); }
+
+void IndirectRenderer::release() {
+  for (Arena &arena : arenas_) {
+    glDeleteVertexArrays(1, &arena.vao);
+    glDeleteBuffers(1, &arena.vbo);
+    glDeleteBuffers(1, &arena.ebo);
+  }
+  arenas_.clear();
+  placements_.clear();
+  // Les noms supprimés peuvent être réutilisés par les prochains objets.
+  GlStateCache::invalidate();
+}
+
+void IndirectRenderer::build(const std::vector<const Model *> &models,
+                             StreamBuffer &stream) {
+  release();
+  stream_ = &stream;
+
+  // Répartition des modèles par format, et taille des tampons partagés.
+  struct Size {
+    GLsizeiptr vertices = 0, indices = 0;
+  };
+  std::vector<Size> sizes;
+  for (const Model *model : models) {
+    if (placements_.count(model) != 0)
+      continue;
+    auto sameFormat = [&](const Arena &arena) {
+      return arena.format == model->vertexFormat() &&
+             arena.indexType == model->indexType();
+    };
+    size_t index =
+        std::find_if(arenas_.begin(), arenas_.end(), sameFormat) -
+        arenas_.begin();
+    if (index == arenas_.size()) {
+      arenas_.push_back({model->vertexFormat(), model->indexType()});
+      sizes.emplace_back();
+    }
+    Size &size = sizes[index];
+    placements_[model] = {
+        index,
+        static_cast<GLint>(size.vertices /
+                           vertexSize(model->vertexFormat())),
+        static_cast<GLuint>(size.indices / indexTypeSize(model->indexType()))};
+    size.vertices += model->vertexBufferSize();
+    size.indices += model->indexBufferSize();
+  }
+
+  // Création des tampons, copie des modèles sur la carte graphique puis
+  // description des attributs.
+  for (size_t i = 0; i < arenas_.size(); ++i) {
+    Arena &arena = arenas_[i];
+    glGenVertexArrays(1, &arena.vao);
+    glGenBuffers(1, &arena.vbo);
+    glGenBuffers(1, &arena.ebo);
+    GlStateCache::bindVertexArray(arena.vao);
+    GlStateCache::bindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizes[i].vertices, nullptr, GL_STATIC_DRAW);
+    GlStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizes[i].indices, nullptr,
+                 GL_STATIC_DRAW);
+    Model::setVertexAttributes(arena.format);
+
+    // Les données de dessin sont lues dans stream, à partir de sa position
+    // 0: le baseInstance des commandes donne l'enregistrement.
+    GlStateCache::bindBuffer(GL_ARRAY_BUFFER, stream.buffer());
+    glVertexAttribIPointer(2, 1, GL_INT, sizeof(DrawData),
+                           (void *)offsetof(DrawData, firstObject));
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(DrawData),
+                          (void *)offsetof(DrawData, positionScale));
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(DrawData),
+                          (void *)offsetof(DrawData, positionOffset));
+    glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(DrawData),
+                          (void *)offsetof(DrawData, colorMod));
+    for (GLuint attribute = 2; attribute <= 5; ++attribute) {
+      glEnableVertexAttribArray(attribute);
+      glVertexAttribDivisor(attribute, DRAW_DATA_DIVISOR);
+    }
+  }
+  GlStateCache::bindVertexArray(0);
+
+  for (const auto &[model, placement] : placements_) {
+    const Arena &arena = arenas_[placement.arena];
+    model->copyBuffers(
+        arena.vbo,
+        static_cast<GLintptr>(placement.baseVertex *
+                              vertexSize(arena.format)),
+        arena.ebo,
+        static_cast<GLintptr>(placement.firstIndex *
+                              indexTypeSize(arena.indexType)));
+  }
+}
+
+GLuint IndirectRenderer::vertexArray(const Model &model) const {
+  auto it = placements_.find(&model);
+  return it == placements_.end() ? 0 : arenas_[it->second.arena].vao;
+}
+
+void IndirectRenderer::draw(
+    const std::vector<const DrawPacket *> &packets,
+    const std::function<void(const DrawPacket &)> &drawDirect) {
+  // Une commande et des données de dessin par dessin, regroupés en suites.
+  commands_.clear();
+  drawData_.clear();
+  runs_.clear();
+  for (const DrawPacket *packet : packets) {
+    auto it = placements_.find(packet->model);
+    if (it == placements_.end()) {
+      runs_.push_back({packet, 0, false, 0, 0});
+      continue;
+    }
+    const Placement &placement = it->second;
+    if (runs_.empty() || runs_.back().packet != nullptr ||
+        runs_.back().arena != placement.arena ||
+        runs_.back().isTwoSided != packet->isTwoSided)
+      runs_.push_back(
+          {nullptr, placement.arena, packet->isTwoSided, commands_.size(), 0});
+    ++runs_.back().commandCount;
+
+    const std::vector<MeshLod> &lods = packet->model->lods();
+    const MeshLod &lod = lods[std::min(packet->lod, lods.size() - 1)];
+    const Dequantization &dequantization = packet->model->dequantization();
+    commands_.push_back({lod.indexCount, static_cast<GLuint>(packet->count),
+                         placement.firstIndex + lod.firstIndex,
+                         placement.baseVertex,
+                         static_cast<GLuint>(commands_.size())});
+    drawData_.push_back({packet->firstObject, dequantization.scale,
+                         dequantization.offset, packet->colorMod});
+  }
+  // Les données de dessin sont alignées sur leur taille pour que leur
+  // position soit un numéro d'enregistrement.
+  GLintptr drawDataOffset = stream_->write(drawData_, sizeof(DrawData));
+  GLintptr commandOffset = StreamBuffer::FULL;
+  if (drawDataOffset != StreamBuffer::FULL) {
+    GLuint firstRecord =
+        static_cast<GLuint>(drawDataOffset / sizeof(DrawData));
+    for (Command &command : commands_)
+      command.baseInstance += firstRecord;
+    commandOffset = stream_->write(commands_);
+  }
+
+  for (const Run &run : runs_) {
+    if (run.packet != nullptr) {
+      drawDirect(*run.packet);
+      continue;
+    }
+    // Région pleine: seuls les dessins directs sont faits.
+    if (commandOffset == StreamBuffer::FULL)
+      continue;
+    const Arena &arena = arenas_[run.arena];
+    GlStateCache::useProgram(program_);
+    GlStateCache::setEnabled(GL_CULL_FACE, !run.isTwoSided);
+    GlStateCache::bindVertexArray(arena.vao);
+    GlStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, stream_->buffer());
+    glMultiDrawElementsIndirect(
+        GL_TRIANGLES, arena.indexType,
+        (void *)(commandOffset + run.firstCommand * sizeof(Command)),
+        static_cast<GLsizei>(run.commandCount), 0);
+  }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <glbinding/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include "mesh.hpp"
+#include "model.hpp"
+#include "render_queue.hpp"
+#include "stream_buffer.hpp"
+
+// Rendu des dessins d'une trame par glMultiDrawElementsIndirect (OpenGL 4.3).
+//
+// Les modèles sont copiés dans des tampons partagés, un VAO par format de
+// sommets et type d'indice. À chaque trame, une commande indirecte et un
+// enregistrement de données de dessin (premier objet, déquantification,
+// modulation de couleur) sont écrits par dessin dans un StreamBuffer, puis
+// chaque suite de
+// dessins qui partagent les mêmes tampons et le même état est faite en un
+// seul appel: le coût CPU des appels ne dépend plus du nombre d'objets.
+class IndirectRenderer {
+public:
+  // Vrai si le contexte actuel est d'OpenGL 4.3 ou plus.
+  static bool isSupported();
+
+  IndirectRenderer() = default;
+
+  IndirectRenderer(const IndirectRenderer &) = delete;
+  IndirectRenderer &operator=(const IndirectRenderer &) = delete;
+
+  ~IndirectRenderer();
+
+  // Programme des dessins indirects, qui lit les données de dessin (voir
+  // transform_indirect.vs.glsl), utilisé à la place de celui des dessins.
+  void setProgram(gl::GLuint program) { program_ = program; }
+
+  // Copie les modèles, déjà chargés, dans les tampons partagés, en
+  // remplacement des modèles copiés auparavant. Les commandes et les données
+  // de dessin de chaque trame sont écrites dans stream.
+  void build(const std::vector<const Model *> &models, StreamBuffer &stream);
+
+  // VAO partagé qui contient le modèle, 0 s'il n'a pas été copié.
+  gl::GLuint vertexArray(const Model &model) const;
+
+  // Exécute les dessins dans l'ordre donné. Les dessins dont le modèle n'a
+  // pas été copié sont passés à drawDirect.
+  void draw(const std::vector<const DrawPacket *> &packets,
+            const std::function<void(const DrawPacket &)> &drawDirect);
+
+private:
+  // Disposition de glMultiDrawElementsIndirect.
+  struct Command {
+    gl::GLuint count;
+    gl::GLuint instanceCount;
+    gl::GLuint firstIndex;
+    gl::GLint baseVertex;
+    gl::GLuint baseInstance;
+  };
+
+  // Données d'un dessin, lues par les attributs 2 à 5 du nuanceur.
+  struct DrawData {
+    gl::GLint firstObject;
+    glm::vec3 positionScale;
+    glm::vec3 positionOffset;
+    glm::vec3 colorMod;
+  };
+
+  // Tampons partagés par les modèles d'un format de sommets et d'un type
+  // d'indice.
+  struct Arena {
+    VertexFormat format;
+    gl::GLenum indexType;
+    gl::GLuint vao = 0, vbo = 0, ebo = 0;
+  };
+
+  // Emplacement d'un modèle dans ses tampons partagés.
+  struct Placement {
+    size_t arena;
+    gl::GLint baseVertex;
+    gl::GLuint firstIndex;
+  };
+
+  // Suite de dessins faite en un appel, ou dessin direct si packet n'est pas
+  // nul.
+  struct Run {
+    const DrawPacket *packet;
+    size_t arena;
+    bool isTwoSided;
+    size_t firstCommand;
+    size_t commandCount;
+  };
+
+  void release();
+
+  gl::GLuint program_ = 0;
+  std::vector<Arena> arenas_;
+  std::unordered_map<const Model *, Placement> placements_;
+  StreamBuffer *stream_ = nullptr;
+  // Contenu de la trame, gardé d'une trame à l'autre pour la mémoire.
+  std::vector<Command> commands_;
+  std::vector<DrawData> drawData_;
+  std::vector<Run> runs_;
+};
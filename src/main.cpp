@@ -1,5 +1,14 @@
 #include "car.hpp"
+#include "frustum_culling.hpp"
+#include "gl_state.hpp"
+#include "indirect_renderer.hpp"
 #include "model.hpp"
+#include "model_loader.hpp"
+#include "model_registry.hpp"
+#include "object_buffer.hpp"
+#include "render_queue.hpp"
+#include "stream_buffer.hpp"
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
 #include <glm/glm.hpp>
@@ -8,7 +17,9 @@
 #include <imgui/imgui.h>
 #include <inf2705/OpenGLApplication.hpp>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 #define CHECK_GL_ERROR printGLError(__FILE__, __LINE__)
 
@@ -21,16 +32,40 @@ struct Vertex {
   glm::vec3 color;    // Couleur (r, g, b)
 };
 
+// Contenu du bloc uniforme Camera (disposition std140).
+struct CameraUniforms {
+  glm::mat4 view;
+  glm::mat4 projection;
+  GLint objectBase;
+  GLint padding[3];
+};
+
+// Instances visibles d'un modèle répété, regroupées par niveau de détail: les
+// instances du niveau lod utilisent les matrices first + lodStarts[lod] à
+// first + lodStarts[lod + 1] - 1 du tampon d'objets, et la plus proche est à
+// la profondeur lodDepths[lod].
+struct InstanceGroup {
+  GLint first = 0;
+  std::vector<size_t> lodStarts;
+  std::vector<float> lodDepths;
+};
+
 struct App : public OpenGLApplication {
   App()
       : nSide_(5), oldNSide_(0), cameraPosition_(0.f, 10.f, 30.f),
         cameraOrientation_(glm::radians(-15.0f), 0.f), currentScene_(0),
         isMouseMotionEnabled_(false), isAutopilotEnabled_(true),
-        trackDistance_(0.0f) {
+        isStaticBatchingEnabled_(false), trackDistance_(0.0f) {
     car_.position = glm::vec3(0.0f, 0.0f, 15.0f);
     car_.orientation.y = glm::radians(180.0f);
   }
 
+  // Lecture des modèles en arrière-plan pendant la création du contexte.
+  void preload() override {
+    modelLoader_ = std::make_unique<ModelLoader>();
+    loadModels();
+  }
+
   void init() override {
     // Le message expliquant les touches de clavier.
     setKeybindMessage("ESC : quitter l'application.\n"
@@ -47,18 +82,25 @@ struct App : public OpenGLApplication {
 
     // Config de base.
     glClearColor(0.5f, 0.5f, 0.5f, 1.0f); // Gris moyen
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    GlStateCache::setEnabled(GL_DEPTH_TEST, true);
+    GlStateCache::setEnabled(GL_CULL_FACE, true);
 
+    isIndirectSupported_ = IndirectRenderer::isSupported();
     loadShaderPrograms();
+    initStreamBuffer();
 
     // Partie 1
     initShapeData();
 
-    // Partie 2
-    loadModels();
+    // Partie 2: transfert des modèles lus depuis preload(). Les fils de
+    // lecture ne servent plus ensuite.
+    modelLoader_->finish();
+    modelLoader_.reset();
+    updateLodTolerance(window_.getSize().y);
 
     initStaticMatrices();
+    initStaticBatches();
+    initIndirectRenderer();
   }
 
   void checkShaderCompilingError(const char *name, GLuint id) {
@@ -81,6 +123,7 @@ struct App : public OpenGLApplication {
     glGetProgramiv(id, GL_LINK_STATUS, &success);
     if (!success) {
       glGetProgramInfoLog(id, 1024, NULL, infoLog);
+      GlStateCache::forgetProgram(id);
       glDeleteProgram(id);
       std::cout << "Program \"" << name << "\" linking error: " << infoLog
                 << std::endl;
@@ -89,11 +132,18 @@ struct App : public OpenGLApplication {
 
   // Appelée à chaque trame. Le buffer swap est fait juste après.
   void drawFrame() override {
+    // ImGui change l'état OpenGL entre deux trames.
+    GlStateCache::beginFrame();
+    stream_.beginFrame();
+
     // Nettoyage de la surface de dessin.
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    GlStateCache::Stats glStats = GlStateCache::lastFrameStats();
     ImGui::Begin("Scene Parameters");
     ImGui::Combo("Scene", &currentScene_, SCENE_NAMES, N_SCENE_NAMES);
+    ImGui::Text("GL state calls: %u issued, %u skipped", glStats.issued,
+                glStats.skipped);
     ImGui::End();
 
     switch (currentScene_) {
@@ -104,16 +154,17 @@ struct App : public OpenGLApplication {
       sceneModels();
       break;
     }
+    stream_.endFrame();
   }
 
   // Appelée lorsque la fenêtre se ferme.
   void onClose() override {
     // Libère les ressources allouées
     glDeleteVertexArrays(1, &vao_);
-    glDeleteBuffers(1, &vbo_);
-    glDeleteBuffers(1, &ebo_);
-    glDeleteProgram(basicSP_);
-    glDeleteProgram(transformSP_);
+    for (GLuint program : {basicSP_, transformSP_, transformIndirectSP_}) {
+      GlStateCache::forgetProgram(program);
+      glDeleteProgram(program);
+    }
   }
 
   // Appelée lors d'une touche de clavier.
@@ -136,7 +187,17 @@ struct App : public OpenGLApplication {
     }
   }
 
-  void onResize(const sf::Event::Resized &event) override {}
+  void onResize(const sf::Event::Resized &event) override {
+    updateLodTolerance(event.size.y);
+  }
+
+  // Les niveaux de détail sont choisis pour une erreur d'au plus
+  // LOD_PIXEL_TOLERANCE pixels à l'écran.
+  void updateLodTolerance(unsigned int windowHeight) {
+    const float LOD_PIXEL_TOLERANCE = 1.0f;
+    Model::setLodTolerance(LOD_PIXEL_TOLERANCE * 2.0f /
+                           std::max(windowHeight, 1u));
+  }
 
   void onMouseMove(const sf::Event::MouseMoved &mouseDelta) override {
     if (!isMouseMotionEnabled_)
@@ -188,12 +249,26 @@ struct App : public OpenGLApplication {
   }
 
   void loadModels() {
-    car_.loadModels();
-    tree_.load("../models/pine.ply");
-    streetlight_.load("../models/streetlight.ply");
-    grass_.load("../models/grass.ply");
-    street_.load("../models/street.ply");
-    streetcorner_.load("../models/streetcorner.ply");
+    // Les éléments du décor, nombreux à l'écran, utilisent des sommets
+    // quantifiés, nettoyés et optimisés pour la cache de sommets.
+    MeshLoadOptions options;
+    options.weldVertices = true;
+    options.optimizeVertexOrder = true;
+    options.lodLevels = 4;
+    for (Model *model : {&tree_, &streetlight_, &grass_, &street_,
+                         &streetcorner_}) {
+      model->setVertexFormat(VertexFormat::Quantized);
+      model->setLoadOptions(options);
+    }
+
+    car_.loadModels(modelRegistry_, *modelLoader_);
+    // Les maillages du décor sont gardés pour initStaticBatches().
+    modelLoader_->request(tree_, TREE_PATH, &treeMesh_);
+    modelLoader_->request(streetlight_, STREETLIGHT_PATH, &streetlightMesh_);
+    modelLoader_->request(grass_, GRASS_PATH, &grassMesh_);
+    modelLoader_->request(street_, STREET_PATH, &streetMesh_);
+    modelLoader_->request(streetcorner_, STREETCORNER_PATH,
+                          &streetcornerMesh_);
   }
 
   GLuint loadShaderObject(GLenum type, const char *path) {
@@ -225,6 +300,7 @@ struct App : public OpenGLApplication {
 
     // 4. Lie (link) le programme pour créer l'exécutable GPU.
     glLinkProgram(p);
+    GlStateCache::forgetProgram(p);
 
     // 5. Vérifie s'il y a eu des erreurs lors de la liaison.
     checkProgramLinkingError(name, p);
@@ -247,12 +323,42 @@ struct App : public OpenGLApplication {
         createProgram("transform.vs.glsl", "transform.fs.glsl", "transform");
 
     // Récupération des emplacements des variables uniformes.
-    mvpUniformLocation_ = glGetUniformLocation(transformSP_, "uMVP");
     colorModUniformLocation_ = glGetUniformLocation(transformSP_, "uColorMod");
-
-    // Transmission des locations à l'objet Car pour son rendu
-    car_.mvpUniformLocation = mvpUniformLocation_;
-    car_.colorModUniformLocation = colorModUniformLocation_;
+    Model::setDequantizationUniforms(
+        glGetUniformLocation(transformSP_, "uPositionScale"),
+        glGetUniformLocation(transformSP_, "uPositionOffset"));
+    Model::setObjectIndexUniform(
+        glGetUniformLocation(transformSP_, "uObjectIndex"));
+
+    // Le bloc de la caméra et le tampon des matrices d'objets sont toujours
+    // liés aux mêmes points.
+    glUniformBlockBinding(transformSP_,
+                          glGetUniformBlockIndex(transformSP_, "Camera"),
+                          CAMERA_BINDING);
+    GlStateCache::useProgram(transformSP_);
+    GlStateCache::uniform(glGetUniformLocation(transformSP_, "uObjectMatrices"),
+                          ObjectBuffer::TEXTURE_UNIT);
+
+    RenderQueue::setColorModUniform(colorModUniformLocation_);
+
+    // Variante pour les dessins indirects, qui lit la déquantification, la
+    // modulation de couleur et le premier objet dans les données de dessin.
+    if (isIndirectSupported_) {
+      transformIndirectSP_ =
+          createProgram("transform_indirect.vs.glsl", "transform.fs.glsl",
+                        "transform_indirect");
+      glUniformBlockBinding(
+          transformIndirectSP_,
+          glGetUniformBlockIndex(transformIndirectSP_, "Camera"),
+          CAMERA_BINDING);
+      GlStateCache::useProgram(transformIndirectSP_);
+      GlStateCache::uniform(
+          glGetUniformLocation(transformIndirectSP_, "uObjectMatrices"),
+          ObjectBuffer::TEXTURE_UNIT);
+      GlStateCache::uniform(
+          glGetUniformLocation(transformIndirectSP_, "uColorMod"),
+          glm::vec3(1.0f));
+    }
   }
 
   // Génération d'un polygone régulier avec une triangulation en éventail.
@@ -273,23 +379,21 @@ struct App : public OpenGLApplication {
     }
   }
 
+  // Les sommets et les indices du polygone sont réécrits à chaque trame dans
+  // stream_: le VAO lit les sommets depuis le début du tampon et chaque
+  // dessin donne la position des siens.
   void initShapeData() {
-    glGenBuffers(1, &vbo_);
-    glGenBuffers(1, &ebo_);
     glGenVertexArrays(1, &vao_);
-    glBindVertexArray(vao_);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices_), nullptr, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements_), nullptr,
-                 GL_DYNAMIC_DRAW);
+    GlStateCache::bindVertexArray(vao_);
+    GlStateCache::bindBuffer(GL_ARRAY_BUFFER, stream_.buffer());
+    GlStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream_.buffer());
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
                           (void *)offsetof(Vertex, position));
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
                           (void *)offsetof(Vertex, color));
     glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+    GlStateCache::bindVertexArray(0);
   }
 
   void sceneShape() {
@@ -299,44 +403,112 @@ struct App : public OpenGLApplication {
     if (nSide_ != oldNSide_) {
       oldNSide_ = nSide_;
       generateNgon();
-      glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-      glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex) * nSide_, vertices_);
-      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-      glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0,
-                      sizeof(GLuint) * (nSide_ - 2) * 3, elements_);
     }
-    glUseProgram(basicSP_);
-    glBindVertexArray(vao_);
-    glDrawElements(GL_TRIANGLES, (nSide_ - 2) * 3, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    // Les sommets sont alignés sur leur taille pour que leur position soit
+    // un numéro de sommet.
+    GLsizei nElements = (nSide_ - 2) * 3;
+    GLintptr verticesOffset =
+        stream_.write(vertices_, sizeof(Vertex) * nSide_, sizeof(Vertex));
+    GLintptr elementsOffset =
+        stream_.write(elements_, sizeof(GLuint) * nElements, sizeof(GLuint));
+    if (verticesOffset == StreamBuffer::FULL ||
+        elementsOffset == StreamBuffer::FULL)
+      return;
+
+    GlStateCache::useProgram(basicSP_);
+    GlStateCache::setEnabled(GL_CULL_FACE, true);
+    GlStateCache::bindVertexArray(vao_);
+    glDrawElementsBaseVertex(
+        GL_TRIANGLES, nElements, GL_UNSIGNED_INT, (void *)elementsOffset,
+        static_cast<GLint>(verticesOffset / sizeof(Vertex)));
   }
 
-  // Rendu d'un modèle PLY avec modulation de couleur et transformation MVP.
-  void drawModel(const Model &m, const glm::mat4 &pv, const glm::mat4 &mm) {
-    glm::mat4 mvp = pv * mm;
-    glUniformMatrix4fv(mvpUniformLocation_, 1, GL_FALSE, glm::value_ptr(mvp));
-    m.draw();
+  // Soumet à renderQueue_ le dessin d'un modèle PLY. object est le numéro de
+  // sa matrice de modèle dans objects_ et wb ses volumes englobants dans le
+  // monde.
+  void submitModel(const Model &m, const glm::mat4 &pv, GLint object,
+                   const Bounds &wb, bool isTwoSided = false) {
+    DrawPacket packet;
+    packet.program = transformSP_;
+    packet.model = &m;
+    packet.firstObject = object;
+    packet.lod = m.selectLod(pv, wb);
+    packet.isTwoSided = isTwoSided;
+    renderQueue_.submit(packet, renderQueue_.depth(wb));
   }
 
-  void drawStreetlights(glm::mat4 &pv) {
-    for (int i = 0; i < N_STREETLIGHTS; ++i)
-      drawModel(streetlight_, pv, streetlightModelMatrices_[i]);
+  // Ajoute à objects_ les matrices mm des n copies visibles d'un modèle, de
+  // volumes englobants wb, regroupées par niveau de détail.
+  void prepareInstances(InstanceGroup &group, const Model &m,
+                        const glm::mat4 &pv, const glm::mat4 *mm,
+                        const Bounds *wb, const uint8_t *isVisible, int n) {
+    // Tri par dénombrement des instances selon leur niveau de détail.
+    instanceLods_.assign(n, 0);
+    group.lodStarts.assign(m.lodCount() + 1, 0);
+    group.lodDepths.assign(m.lodCount(), INFINITY);
+    for (int i = 0; i < n; ++i) {
+      if (!isVisible[i])
+        continue;
+      size_t lod = instanceLods_[i] = m.selectLod(pv, wb[i]);
+      ++group.lodStarts[lod + 1];
+      group.lodDepths[lod] =
+          std::min(group.lodDepths[lod], renderQueue_.depth(wb[i]));
+    }
+    for (size_t lod = 0; lod < m.lodCount(); ++lod)
+      group.lodStarts[lod + 1] += group.lodStarts[lod];
+
+    instanceMatrices_.resize(group.lodStarts.back());
+    std::vector<size_t> next(group.lodStarts.begin(),
+                             group.lodStarts.end() - 1);
+    for (int i = 0; i < n; ++i)
+      if (isVisible[i])
+        instanceMatrices_[next[instanceLods_[i]]++] = mm[i];
+
+    group.first = static_cast<GLint>(objects_.size());
+    for (const glm::mat4 &matrix : instanceMatrices_)
+      objects_.push(matrix);
+  }
+
+  // Soumet un groupe préparé par prepareInstances(), avec un seul dessin
+  // instancié par niveau de détail.
+  void submitInstances(const InstanceGroup &group, const Model &m) {
+    for (size_t lod = 0; lod + 1 < group.lodStarts.size(); ++lod) {
+      DrawPacket packet;
+      packet.program = transformSP_;
+      packet.model = &m;
+      packet.firstObject =
+          group.first + static_cast<GLint>(group.lodStarts[lod]);
+      packet.count = group.lodStarts[lod + 1] - group.lodStarts[lod];
+      packet.lod = lod;
+      renderQueue_.submit(packet, group.lodDepths[lod]);
+    }
   }
 
-  void drawTree(glm::mat4 &pv) {
+  void submitStreetlights() {
+    submitInstances(streetlightInstances_, streetlight_);
+  }
+
+  void submitTree(glm::mat4 &pv) {
     // L'arbre nécessite de désactiver le face culling pour voir l'intérieur des
     // branches
-    glDisable(GL_CULL_FACE);
-    drawModel(tree_, pv, treeModelMatrice_);
-    glEnable(GL_CULL_FACE);
+    if (isVisible_[CULL_TREE])
+      submitModel(tree_, pv, treeObject_, treeBounds_, true);
+  }
+
+  void submitGround(glm::mat4 &pv) {
+    if (isVisible_[CULL_GROUND])
+      submitModel(grass_, pv, groundObject_, groundBounds_);
+    submitInstances(streetcornerInstances_, streetcorner_);
+    submitInstances(streetInstances_, street_);
   }
 
-  void drawGround(glm::mat4 &pv) {
-    drawModel(grass_, pv, groundModelMatrice_);
-    for (int i = 0; i < 4; ++i)
-      drawModel(streetcorner_, pv, streetPatchesModelMatrices_[i]);
-    for (int i = 4; i < N_STREET_PATCHES; ++i)
-      drawModel(street_, pv, streetPatchesModelMatrices_[i]);
+  // Le décor immobile est dessiné en deux appels, sans élimination des
+  // objets hors du champ de vision ni niveaux de détail; le second est
+  // dessiné sans face culling.
+  void submitStaticBatches(glm::mat4 &pv) {
+    submitModel(staticBatch_, pv, identityObject_, staticBatch_.bounds());
+    submitModel(twoSidedStaticBatch_, pv, identityObject_,
+                twoSidedStaticBatch_.bounds(), true);
   }
 
   glm::mat4 getViewMatrix() {
@@ -364,6 +536,9 @@ struct App : public OpenGLApplication {
     ImGui::Checkbox("Right Blinker", &car_.isRightBlinkerActivated);
     ImGui::Checkbox("Brake", &car_.isBraking);
     ImGui::Checkbox("Auto drive", &isAutopilotEnabled_);
+    ImGui::Checkbox("Static batching", &isStaticBatchingEnabled_);
+    if (isIndirectSupported_)
+      ImGui::Checkbox("Multi-draw indirect", &isIndirectEnabled_);
     ImGui::End();
 
     updateCameraInput();
@@ -371,21 +546,96 @@ struct App : public OpenGLApplication {
     if (isAutopilotEnabled_)
       updateCarOnTrack(deltaTime_);
 
-    glUseProgram(transformSP_);
+    // Matrices de vue et de projection de la trame, composées avec la matrice
+    // de modèle de chaque objet dans le nuanceur. La matrice de
+    // Projection-Vue (PV) sert aux tests de visibilité et de niveau de détail.
+    glm::mat4 view = getViewMatrix(),
+              projection = getPerspectiveProjectionMatrix();
+    glm::mat4 pv = projection * view;
+    renderQueue_.begin(view,
+                       isIndirectEnabled_ ? &indirectRenderer_ : nullptr);
+
+    // Élimination des objets hors du champ de vision, en un seul passage sur
+    // les boîtes englobantes de toute la scène.
+    cullingSet_.set(CULL_CAR, car_.worldBounds().box);
+    size_t nVisible = cullingSet_.cull(Frustum(pv), isVisible_);
+    ImGui::Begin("Scene Parameters");
+    ImGui::Text("Visible objects: %zu/%zu", nVisible, cullingSet_.size());
+    ImGui::End();
 
-    // Calcul de la matrice de Projection-Vue (PV)
-    glm::mat4 pv = getPerspectiveProjectionMatrix() * getViewMatrix();
+    // Matrices de modèle des objets qui bougent ou dont l'ordre change à
+    // chaque trame, ajoutées après celles des objets immobiles puis écrites
+    // avec elles dans stream_.
+    objects_.truncate(staticObjectCount_);
+    if (!isStaticBatchingEnabled_) {
+      prepareInstances(streetlightInstances_, streetlight_, pv,
+                       streetlightModelMatrices_, streetlightBounds_,
+                       &isVisible_[CULL_STREETLIGHTS], N_STREETLIGHTS);
+      // Les 4 premières parcelles sont les coins.
+      prepareInstances(streetcornerInstances_, streetcorner_, pv,
+                       streetPatchesModelMatrices_, streetPatchesBounds_,
+                       &isVisible_[CULL_STREET_PATCHES], 4);
+      prepareInstances(streetInstances_, street_, pv,
+                       streetPatchesModelMatrices_ + 4,
+                       streetPatchesBounds_ + 4,
+                       &isVisible_[CULL_STREET_PATCHES + 4],
+                       N_STREET_PATCHES - 4);
+    }
+    if (isVisible_[CULL_CAR])
+      car_.prepareDraw(objects_);
+    // Si la région de la trame est pleine, la scène n'est pas dessinée pour
+    // cette trame.
+    GLint objectBase = objects_.upload(stream_);
+    if (objectBase < 0 || !updateCameraBuffer(view, projection, objectBase))
+      return;
 
-    // Rendu des différents composants de la scène
-    drawGround(pv);
-    drawTree(pv);
-    drawStreetlights(pv);
+    // Rendu des différents composants de la scène, dans l'ordre choisi par
+    // la file.
+    if (isStaticBatchingEnabled_) {
+      submitStaticBatches(pv);
+    } else {
+      submitGround(pv);
+      submitTree(pv);
+      submitStreetlights();
+    }
 
     // Rendu de l'automobile
-    car_.draw(pv);
+    if (isVisible_[CULL_CAR])
+      car_.submitDraw(renderQueue_, transformSP_, pv);
+
+    renderQueue_.execute();
+  }
+
+  void initStreamBuffer() {
+    // Le tampon de texture des matrices d'objets couvre tout stream_, mais
+    // n'en lit que GL_MAX_TEXTURE_BUFFER_SIZE texels: les régions sont
+    // réduites pour que toutes restent lisibles.
+    GLint maxTextureBufferTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTextureBufferTexels);
+    size_t maxRegionSize = size_t(maxTextureBufferTexels) *
+                           sizeof(glm::vec4) / StreamBuffer::N_REGIONS;
+    stream_.create(std::min(STREAM_REGION_SIZE, maxRegionSize));
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferAlignment_);
+  }
+
+  // Écriture de la caméra de la trame, une seule fois pour tous les
+  // dessins, avec la position des matrices d'objets de la trame. Retourne
+  // false si la région de la trame est pleine.
+  bool updateCameraBuffer(const glm::mat4 &view, const glm::mat4 &projection,
+                          GLint objectBase) {
+    CameraUniforms camera = {view, projection, objectBase, {}};
+    GLintptr offset = stream_.write(&camera, sizeof(camera),
+                                    size_t(uniformBufferAlignment_));
+    if (offset == StreamBuffer::FULL)
+      return false;
+    GlStateCache::bindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BINDING,
+                                  stream_.buffer(), offset, sizeof(camera));
+    return true;
   }
 
-  // Calcul unique des transformations pour les objets de décor immobiles.
+  // Calcul unique des transformations pour les objets de décor immobiles, et
+  // de leurs volumes englobants dans le monde. Les modèles doivent être
+  // chargés.
   void initStaticMatrices() {
     const float RL = 15.0f, RW = 5.0f, SL = 30.0f / 7.0f;
     groundModelMatrice_ =
@@ -420,6 +670,92 @@ struct App : public OpenGLApplication {
                                  glm::radians(90.0f), {0, 1, 0}),
                      {SL, 1, RW});
     }
+
+    groundBounds_ = grass_.bounds().transformed(groundModelMatrice_);
+    treeBounds_ = tree_.bounds().transformed(treeModelMatrice_);
+    for (int i = 0; i < N_STREETLIGHTS; ++i)
+      streetlightBounds_[i] =
+          streetlight_.bounds().transformed(streetlightModelMatrices_[i]);
+    for (int i = 0; i < N_STREET_PATCHES; ++i) {
+      const Model &patch = i < 4 ? streetcorner_ : street_;
+      streetPatchesBounds_[i] =
+          patch.bounds().transformed(streetPatchesModelMatrices_[i]);
+    }
+
+    // Matrices des objets dessinés un à un, gardées au début du tampon
+    // d'objets d'une trame à l'autre.
+    objects_.truncate(0);
+    groundObject_ = objects_.push(groundModelMatrice_);
+    treeObject_ = objects_.push(treeModelMatrice_);
+    identityObject_ = objects_.push(glm::mat4(1.0f));
+    staticObjectCount_ = objects_.size();
+
+    // Boîtes testées à chaque trame, dans l'ordre des numéros CULL_*. La
+    // boîte de la voiture est mise à jour avant chaque test.
+    cullingSet_.clear();
+    cullingSet_.add(groundBounds_.box);
+    cullingSet_.add(treeBounds_.box);
+    for (const Bounds &bounds : streetlightBounds_)
+      cullingSet_.add(bounds.box);
+    for (const Bounds &bounds : streetPatchesBounds_)
+      cullingSet_.add(bounds.box);
+    cullingSet_.add(car_.worldBounds().box);
+  }
+
+  // Fusion des objets de décor immobiles, transformés dans le repère du
+  // monde, en un maillage par état de rendu: un avec élimination des faces
+  // arrière et un sans, pour l'arbre. Les matrices statiques doivent être
+  // calculées. Les maillages gardés par le chargement sont ensuite libérés;
+  // seuls ceux lus par morceaux sont relus.
+  void initStaticBatches() {
+    auto sceneMesh = [](MeshData &kept, const Model &model,
+                        const char *path) -> const MeshData & {
+      if (kept.vertices.empty())
+        kept = Model::read(path, model.loadOptions());
+      return kept;
+    };
+    MeshData batch, twoSidedBatch;
+    appendTransformedMesh(batch, sceneMesh(grassMesh_, grass_, GRASS_PATH),
+                          groundModelMatrice_);
+    const MeshData &streetlight =
+        sceneMesh(streetlightMesh_, streetlight_, STREETLIGHT_PATH);
+    for (const glm::mat4 &matrix : streetlightModelMatrices_)
+      appendTransformedMesh(batch, streetlight, matrix);
+    const MeshData &streetcorner =
+        sceneMesh(streetcornerMesh_, streetcorner_, STREETCORNER_PATH);
+    const MeshData &street = sceneMesh(streetMesh_, street_, STREET_PATH);
+    for (int i = 0; i < N_STREET_PATCHES; ++i)
+      appendTransformedMesh(batch, i < 4 ? streetcorner : street,
+                            streetPatchesModelMatrices_[i]);
+    appendTransformedMesh(twoSidedBatch,
+                          sceneMesh(treeMesh_, tree_, TREE_PATH),
+                          treeModelMatrice_);
+    for (MeshData *mesh : {&treeMesh_, &streetlightMesh_, &grassMesh_,
+                           &streetMesh_, &streetcornerMesh_})
+      *mesh = {};
+
+    auto upload = [](Model &model, MeshData &mesh) {
+      mesh.computeBounds();
+      model.setVertexFormat(VertexFormat::Quantized);
+      model.load(mesh);
+    };
+    upload(staticBatch_, batch);
+    upload(twoSidedStaticBatch_, twoSidedBatch);
+  }
+
+  // Copie de tous les modèles de la scène dans les tampons partagés du rendu
+  // indirect, choisi par défaut quand le contexte le permet.
+  void initIndirectRenderer() {
+    if (!isIndirectSupported_)
+      return;
+    std::vector<const Model *> models = {&tree_, &streetlight_, &grass_,
+                                         &street_, &streetcorner_,
+                                         &staticBatch_, &twoSidedStaticBatch_};
+    for (const Model *model : car_.models())
+      models.push_back(model);
+    indirectRenderer_.setProgram(transformIndirectSP_);
+    indirectRenderer_.build(models, stream_);
+    isIndirectEnabled_ = true;
   }
 
   // Calcul du pilotage automatique pour suivre le circuit rectangulaire.
@@ -449,25 +785,71 @@ struct App : public OpenGLApplication {
 
 private:
   GLuint basicSP_, transformSP_;
-  GLint colorModUniformLocation_, mvpUniformLocation_;
-  GLuint vbo_, ebo_, vao_;
+  GLint colorModUniformLocation_;
+  GLuint vao_;
   static constexpr unsigned int MIN_N_SIDES = 5, MAX_N_SIDES = 12;
   Vertex vertices_[MAX_N_SIDES + 1];
   GLuint elements_[MAX_N_SIDES * 3];
   int nSide_, oldNSide_;
+  static constexpr const char *TREE_PATH = "../models/pine.ply",
+                              *STREETLIGHT_PATH = "../models/streetlight.ply",
+                              *GRASS_PATH = "../models/grass.ply",
+                              *STREET_PATH = "../models/street.ply",
+                              *STREETCORNER_PATH = "../models/streetcorner.ply";
   Model tree_, streetlight_, grass_, street_, streetcorner_;
+  // Maillages lus pour ces modèles, gardés jusqu'à initStaticBatches().
+  MeshData treeMesh_, streetlightMesh_, grassMesh_, streetMesh_,
+      streetcornerMesh_;
+  // Décor immobile fusionné, pour le mode de rendu par lots statiques.
+  Model staticBatch_, twoSidedStaticBatch_;
+  ModelRegistry modelRegistry_;
   Car car_;
+  std::unique_ptr<ModelLoader> modelLoader_;
   glm::vec3 cameraPosition_;
   glm::vec2 cameraOrientation_;
   static constexpr unsigned int N_STREETLIGHTS = 8, N_STREET_PATCHES = 32;
   glm::mat4 treeModelMatrice_, groundModelMatrice_,
       streetlightModelMatrices_[N_STREETLIGHTS],
       streetPatchesModelMatrices_[N_STREET_PATCHES];
+  Bounds treeBounds_, groundBounds_, streetlightBounds_[N_STREETLIGHTS],
+      streetPatchesBounds_[N_STREET_PATCHES];
+  // Numéros des objets dans cullingSet_ et isVisible_.
+  static constexpr size_t CULL_GROUND = 0, CULL_TREE = 1, CULL_STREETLIGHTS = 2,
+                          CULL_STREET_PATCHES =
+                              CULL_STREETLIGHTS + N_STREETLIGHTS,
+                          CULL_CAR = CULL_STREET_PATCHES + N_STREET_PATCHES;
+  CullingSet cullingSet_;
+  std::vector<uint8_t> isVisible_;
+  // Matrices de modèle de tous les objets de la trame. Les objets immobiles
+  // dessinés un à un occupent les staticObjectCount_ premières.
+  ObjectBuffer objects_;
+  size_t staticObjectCount_ = 0;
+  GLint groundObject_, treeObject_, identityObject_;
+  InstanceGroup streetlightInstances_, streetcornerInstances_,
+      streetInstances_;
+  // Tampons réutilisés par prepareInstances().
+  std::vector<glm::mat4> instanceMatrices_;
+  std::vector<size_t> instanceLods_;
+  // Dessins de la trame, triés avant leur exécution.
+  RenderQueue renderQueue_;
+  // Rendu par glMultiDrawElementsIndirect, si le contexte est d'OpenGL 4.3
+  // ou plus; sinon, les dessins sont faits un à un.
+  IndirectRenderer indirectRenderer_;
+  GLuint transformIndirectSP_ = 0;
+  bool isIndirectSupported_ = false, isIndirectEnabled_ = false;
+  // Caméra de la trame (bloc uniforme Camera de transform.vs.glsl).
+  static constexpr GLuint CAMERA_BINDING = 0;
+  // Données réécrites à chaque trame: de quoi loger plus de 100 000 matrices
+  // d'objets par région, sauf si la limite des tampons de texture est plus
+  // petite (voir initStreamBuffer()).
+  static constexpr size_t STREAM_REGION_SIZE = size_t(8) << 20;
+  StreamBuffer stream_;
+  GLint uniformBufferAlignment_ = 1;
   const char *const SCENE_NAMES[2] = {"Introduction",
                                       "3D Model & transformation"};
   const int N_SCENE_NAMES = 2;
   int currentScene_;
-  bool isMouseMotionEnabled_, isAutopilotEnabled_;
+  bool isMouseMotionEnabled_, isAutopilotEnabled_, isStaticBatchingEnabled_;
   float trackDistance_;
 };
 
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+// Projection en mémoire d'un fichier en lecture seule. Le contenu est
+// accessible directement par data() sans copie vers un tampon intermédiaire.
+class MappedFile {
+public:
+  MappedFile() = default;
+  explicit MappedFile(const char *path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  // Retourne false si le fichier n'existe pas, est vide ou ne peut pas être
+  // projeté.
+  bool open(const char *path);
+
+  void close();
+
+  bool isOpen() const { return data_ != nullptr; }
+
+  const char *data() const { return data_; }
+
+  size_t size() const { return size_; }
+
+private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void *mapping_ = nullptr;
+#endif
+};
@@ -0,0 +1,137 @@
+#include "mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace gl;
+
+BoundingBox computeBoundingBox(const Vertex3D *vertices, size_t count) {
+  BoundingBox box;
+  if (count == 0)
+    return box;
+  box.min = box.max = vertices[0].position;
+  for (size_t i = 1; i < count; ++i) {
+    box.min = glm::min(box.min, vertices[i].position);
+    box.max = glm::max(box.max, vertices[i].position);
+  }
+  return box;
+}
+
+BoundingSphere computeBoundingSphere(const Vertex3D *vertices, size_t count) {
+  if (count == 0)
+    return {};
+
+  // Algorithme de Ritter: sphère initiale sur deux positions éloignées,
+  // agrandie juste assez pour chaque position qui en sort.
+  auto farthestFrom = [&](const glm::vec3 &point) {
+    size_t farthest = 0;
+    float maxDistance = -1.0f;
+    for (size_t i = 0; i < count; ++i) {
+      float distance = glm::dot(vertices[i].position - point,
+                                vertices[i].position - point);
+      if (distance > maxDistance) {
+        maxDistance = distance;
+        farthest = i;
+      }
+    }
+    return vertices[farthest].position;
+  };
+  glm::vec3 a = farthestFrom(vertices[0].position);
+  glm::vec3 b = farthestFrom(a);
+  BoundingSphere ritter = {(a + b) * 0.5f, glm::length(b - a) * 0.5f};
+  for (size_t i = 0; i < count; ++i) {
+    glm::vec3 toPoint = vertices[i].position - ritter.center;
+    float distance = glm::length(toPoint);
+    if (distance > ritter.radius) {
+      float radius = (ritter.radius + distance) * 0.5f;
+      ritter.center += toPoint * ((radius - ritter.radius) / distance);
+      ritter.radius = radius;
+    }
+  }
+
+  // La sphère centrée sur la boîte englobante est parfois plus petite (ex.
+  // formes allongées et symétriques).
+  BoundingSphere centered = {computeBoundingBox(vertices, count).center(),
+                             0.0f};
+  for (size_t i = 0; i < count; ++i)
+    centered.radius =
+        std::max(centered.radius,
+                 glm::length(vertices[i].position - centered.center));
+  return centered.radius < ritter.radius ? centered : ritter;
+}
+
+Dequantization quantizeVertices(const Vertex3D *src, size_t count,
+                                QuantizedVertex3D *dst) {
+  BoundingBox box = computeBoundingBox(src, count);
+
+  // Le centre de la boîte est ramené à 0 et ses faces à -1 et 1. Un axe plat
+  // garde une échelle de 1 pour éviter une division par 0.
+  Dequantization dequantization;
+  dequantization.offset = box.center();
+  dequantization.scale = box.extents();
+  for (int axis = 0; axis < 3; ++axis)
+    if (dequantization.scale[axis] <= 0.0f)
+      dequantization.scale[axis] = 1.0f;
+
+  const glm::vec3 toUnit = 1.0f / dequantization.scale;
+  for (size_t i = 0; i < count; ++i) {
+    glm::vec3 unit = glm::clamp(
+        (src[i].position - dequantization.offset) * toUnit, -1.0f, 1.0f);
+    for (int axis = 0; axis < 3; ++axis) {
+      dst[i].position[axis] =
+          static_cast<GLshort>(std::lround(unit[axis] * 32767.0f));
+      dst[i].color[axis] =
+          static_cast<GLubyte>(std::lround(src[i].color[axis] * 255.0f));
+    }
+    dst[i].padding = 0;
+    dst[i].color[3] = 255;
+  }
+  return dequantization;
+}
+
+uint32_t MeshLoadOptions::cacheKey() const {
+  return (optimizeVertexOrder ? 1u : 0u) | (weldVertices ? 2u : 0u) |
+         (std::max(lodLevels, 1u) << 8);
+}
+
+void MeshData::computeBounds() {
+  bounds.box = computeBoundingBox(vertices.data(), vertices.size());
+  bounds.sphere = computeBoundingSphere(vertices.data(), vertices.size());
+}
+
+void MeshData::readVertices(Vertex3D *dst) const {
+  std::copy(vertices.begin(), vertices.end(), dst);
+}
+
+void MeshData::readIndices(GLuint *dst) const {
+  std::copy(indices.begin(), indices.end(), dst);
+}
+
+void MeshData::readLods(MeshLod *dst) const {
+  if (lods.empty())
+    *dst = {0, static_cast<GLuint>(indices.size()), 0.0f};
+  else
+    std::copy(lods.begin(), lods.end(), dst);
+}
+
+void appendTransformedMesh(MeshData &batch, const MeshData &mesh,
+                           const glm::mat4 &transform) {
+  GLuint base = static_cast<GLuint>(batch.vertices.size());
+  for (const Vertex3D &vertex : mesh.vertices)
+    batch.vertices.push_back(
+        {glm::vec3(transform * glm::vec4(vertex.position, 1.0f)),
+         vertex.color});
+
+  // Une transformation qui inverse l'orientation (symétrie) inverserait aussi
+  // le sens des triangles: on l'y remet pour l'élimination des faces arrière.
+  MeshLod finest = {0, static_cast<GLuint>(mesh.indices.size()), 0.0f};
+  if (!mesh.lods.empty())
+    finest = mesh.lods.front();
+  bool isMirrored = glm::determinant(glm::mat3(transform)) < 0.0f;
+  const GLuint *triangle = mesh.indices.data() + finest.firstIndex;
+  for (GLuint i = 0; i < finest.indexCount; i += 3, triangle += 3) {
+    batch.indices.push_back(base + triangle[0]);
+    batch.indices.push_back(base + triangle[isMirrored ? 2 : 1]);
+    batch.indices.push_back(base + triangle[isMirrored ? 1 : 2]);
+  }
+}
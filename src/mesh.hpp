@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glbinding/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+
+// Sommet tel qu'il est stocké dans le VBO des modèles.
+struct Vertex3D {
+  glm::vec3 position;
+  glm::vec3 color;
+};
+
+// Format des sommets dans le VBO d'un modèle.
+enum class VertexFormat {
+  Float,     // Vertex3D
+  Quantized, // QuantizedVertex3D
+};
+
+// Sommet compact (12 octets au lieu de 24): position en snorm16 relative à la
+// boîte englobante du modèle et couleur en octets normalisés.
+struct QuantizedVertex3D {
+  gl::GLshort position[3];
+  gl::GLshort padding; // Aligne la couleur sur 4 octets.
+  gl::GLubyte color[4];
+};
+
+// Transformation à appliquer aux positions quantifiées dans le nuanceur:
+// position = snorm * scale + offset.
+struct Dequantization {
+  glm::vec3 scale = glm::vec3(1.0f);
+  glm::vec3 offset = glm::vec3(0.0f);
+};
+
+// Boîte englobante alignée sur les axes des positions (nulle si count vaut
+// 0).
+BoundingBox computeBoundingBox(const Vertex3D *vertices, size_t count);
+
+// Sphère englobant les positions, proche de la plus petite (nulle si count
+// vaut 0).
+BoundingSphere computeBoundingSphere(const Vertex3D *vertices, size_t count);
+
+// Quantifie count sommets dans dst, par rapport à leur boîte englobante.
+Dequantization quantizeVertices(const Vertex3D *src, size_t count,
+                                QuantizedVertex3D *dst);
+
+// Traitements optionnels appliqués au maillage lors de sa lecture.
+struct MeshLoadOptions {
+  // Fusionne les sommets identiques et retire les triangles dégénérés.
+  bool weldVertices = false;
+
+  // Réordonne triangles et sommets pour la cache de sommets et la localité
+  // des lectures (voir mesh_optimizer.hpp).
+  bool optimizeVertexOrder = false;
+
+  // Nombre de niveaux de détail, y compris le maillage complet (voir
+  // mesh_simplifier.hpp).
+  unsigned lodLevels = 1;
+
+  // Identifie les traitements dans le cache de maillage, qui n'est valide
+  // que pour les mêmes options.
+  uint32_t cacheKey() const;
+};
+
+// Niveau de détail: plage de l'EBO dessinée pour ce niveau. Tous les niveaux
+// partagent les sommets du modèle.
+struct MeshLod {
+  gl::GLuint firstIndex;
+  gl::GLuint indexCount;
+  float error; // Écart maximal estimé avec le maillage complet.
+};
+
+// Maillage décodé en mémoire, en float et indices 32 bits, avant conversion
+// vers le format des VBO/EBO. Offre la même interface de lecture que
+// PlyMeshReader.
+struct MeshData {
+  std::vector<Vertex3D> vertices;
+  std::vector<gl::GLuint> indices;
+  // Niveaux de détail, du plus fin au plus grossier; vide si indices ne
+  // contient que le maillage complet.
+  std::vector<MeshLod> lods;
+  Bounds bounds;
+
+  // Volumes englobants des positions.
+  void computeBounds();
+
+  size_t vertexCount() const { return vertices.size(); }
+
+  size_t indexCount() const { return indices.size(); }
+
+  void readVertices(Vertex3D *dst) const;
+
+  void readIndices(gl::GLuint *dst) const;
+
+  size_t lodCount() const { return lods.empty() ? 1 : lods.size(); }
+
+  void readLods(MeshLod *dst) const;
+};
+
+// Ajoute à batch les sommets de mesh, transformés par transform, et les
+// triangles de son niveau de détail le plus fin. Les niveaux de détail et les
+// volumes englobants de batch ne sont pas mis à jour.
+void appendTransformedMesh(MeshData &batch, const MeshData &mesh,
+                           const glm::mat4 &transform);
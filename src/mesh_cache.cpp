@@ -0,0 +1,282 @@
+#include "mesh_cache.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace gl;
+
+// À incrémenter dès que la disposition du fichier ou le traitement appliqué
+// aux maillages change, pour invalider les caches existants.
+static constexpr uint32_t MESH_CACHE_VERSION = 5;
+
+struct MeshCacheHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t vertexSize;
+  uint32_t indexSize;
+  uint32_t optionsKey;
+  uint32_t lodCount;
+  uint64_t sourceSize;
+  int64_t sourceTime;
+  uint64_t sourceHash;
+  uint64_t vertexCount;
+  uint64_t indexCount;
+  float boxMin[3];
+  float boxMax[3];
+  float sphereCenter[3];
+  float sphereRadius;
+};
+
+static_assert(sizeof(MeshCacheHeader) % alignof(Vertex3D) == 0,
+              "les sommets doivent suivre l'en-tête sans décalage");
+
+namespace {
+
+const char MAGIC[4] = {'M', 'S', 'H', 'C'};
+
+// Résolution des dates de modification la plus grossière des systèmes de
+// fichiers visés (FAT).
+const auto MTIME_GRANULARITY = std::chrono::seconds(2);
+
+// Hachage 64 bits du contenu, traité par mots de 8 octets.
+uint64_t hashBytes(const char *data, size_t size) {
+  const uint64_t PRIME = 0x100000001b3ull;
+  uint64_t hash = 0xcbf29ce484222325ull ^ size;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data + i, 8);
+    hash = (hash ^ word) * PRIME;
+    hash ^= hash >> 32;
+  }
+  for (; i < size; ++i)
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * PRIME;
+  return hash;
+}
+
+struct SourceStamp {
+  uint64_t size;
+  int64_t time;
+};
+
+bool fileTime(const char *path, int64_t &time) {
+  std::error_code error;
+  auto fileTime = std::filesystem::last_write_time(path, error);
+  if (error)
+    return false;
+  time = static_cast<int64_t>(fileTime.time_since_epoch().count());
+  return true;
+}
+
+bool stampSource(const char *plyPath, SourceStamp &stamp) {
+  std::error_code error;
+  stamp.size = std::filesystem::file_size(plyPath, error);
+  return !error && fileTime(plyPath, stamp.time);
+}
+
+// Vrai si la source a pu être modifiée sans que sa date change après
+// l'écriture du cache: elle date alors de moins de MTIME_GRANULARITY avant
+// le cache.
+bool isStampAmbiguous(int64_t sourceTime, const std::string &cachePath) {
+  int64_t cacheTime;
+  if (!fileTime(cachePath.c_str(), cacheTime))
+    return true;
+  int64_t granularity =
+      std::chrono::duration_cast<std::filesystem::file_time_type::duration>(
+          MTIME_GRANULARITY)
+          .count();
+  return cacheTime - sourceTime < granularity;
+}
+
+bool hashSource(const char *plyPath, uint64_t &hash) {
+  MappedFile source;
+  if (!source.open(plyPath))
+    return false;
+  hash = hashBytes(source.data(), source.size());
+  return true;
+}
+
+} // namespace
+
+std::string meshCachePath(const char *plyPath) {
+  return std::string(plyPath) + ".meshcache";
+}
+
+bool writeMeshCache(const char *plyPath, const MeshData &mesh,
+                    uint32_t optionsKey) {
+  MeshCacheHeader header = {};
+  SourceStamp stamp;
+  if (!stampSource(plyPath, stamp) || !hashSource(plyPath, header.sourceHash))
+    return false;
+
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = MESH_CACHE_VERSION;
+  header.vertexSize = sizeof(Vertex3D);
+  header.indexSize = sizeof(GLuint);
+  header.optionsKey = optionsKey;
+  header.lodCount = static_cast<uint32_t>(mesh.lodCount());
+  header.sourceSize = stamp.size;
+  header.sourceTime = stamp.time;
+  header.vertexCount = mesh.vertices.size();
+  header.indexCount = mesh.indices.size();
+  for (int i = 0; i < 3; ++i) {
+    header.boxMin[i] = mesh.bounds.box.min[i];
+    header.boxMax[i] = mesh.bounds.box.max[i];
+    header.sphereCenter[i] = mesh.bounds.sphere.center[i];
+  }
+  header.sphereRadius = mesh.bounds.sphere.radius;
+
+  // Écriture dans un fichier temporaire puis renommage, pour qu'un autre
+  // chargement ne voie jamais un cache à moitié écrit.
+  std::string path = meshCachePath(plyPath);
+  std::ostringstream tmpPath;
+  tmpPath << path << "." << std::hash<std::thread::id>()(
+                                std::this_thread::get_id())
+          << ".tmp";
+  {
+    std::ofstream out(tmpPath.str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(mesh.vertices.data()),
+              mesh.vertices.size() * sizeof(Vertex3D));
+    out.write(reinterpret_cast<const char *>(mesh.indices.data()),
+              mesh.indices.size() * sizeof(GLuint));
+    std::vector<MeshLod> lods(mesh.lodCount());
+    mesh.readLods(lods.data());
+    out.write(reinterpret_cast<const char *>(lods.data()),
+              lods.size() * sizeof(MeshLod));
+    if (!out) {
+      std::cout << "Warning: Could not write mesh cache \"" << path << "\"."
+                << std::endl;
+      out.close();
+      std::filesystem::remove(tmpPath.str());
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tmpPath.str(), path, error);
+  if (error) {
+    std::filesystem::remove(tmpPath.str(), error);
+    return false;
+  }
+  return true;
+}
+
+bool MeshCacheReader::open(const char *plyPath, uint32_t optionsKey) {
+  header_ = nullptr;
+  if (!file_.open(meshCachePath(plyPath).c_str()) ||
+      file_.size() < sizeof(MeshCacheHeader))
+    return false;
+
+  const auto *header =
+      reinterpret_cast<const MeshCacheHeader *>(file_.data());
+  if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header->version != MESH_CACHE_VERSION ||
+      header->vertexSize != sizeof(Vertex3D) ||
+      header->indexSize != sizeof(GLuint) ||
+      header->optionsKey != optionsKey)
+    return false;
+
+  // Les tailles sont vérifiées par division: les compteurs viennent du
+  // fichier et leur produit peut déborder.
+  size_t remaining = file_.size() - sizeof(MeshCacheHeader);
+  if (header->vertexCount > remaining / sizeof(Vertex3D))
+    return false;
+  remaining -= header->vertexCount * sizeof(Vertex3D);
+  if (header->indexCount > remaining / sizeof(GLuint))
+    return false;
+  remaining -= header->indexCount * sizeof(GLuint);
+  if (header->lodCount == 0 ||
+      remaining != header->lodCount * uint64_t(sizeof(MeshLod)))
+    return false;
+
+  // La taille et la date suffisent à détecter les changements, sauf si la
+  // source a été modifiée trop peu de temps avant l'écriture du cache pour
+  // qu'une autre modification change sa date: le contenu est alors haché.
+  SourceStamp stamp;
+  if (!stampSource(plyPath, stamp) || stamp.size != header->sourceSize ||
+      stamp.time != header->sourceTime)
+    return false;
+  uint64_t hash;
+  if (isStampAmbiguous(stamp.time, meshCachePath(plyPath)) &&
+      (!hashSource(plyPath, hash) || hash != header->sourceHash))
+    return false;
+
+  // Un cache corrompu ne doit pas mener à des lectures hors des tampons lors
+  // des dessins.
+  header_ = header;
+  if (!hasValidIndices()) {
+    header_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool MeshCacheReader::hasValidIndices() const {
+  const char *indexData = file_.data() + sizeof(MeshCacheHeader) +
+                          vertexCount() * sizeof(Vertex3D);
+  for (size_t i = 0; i < indexCount(); ++i) {
+    GLuint index;
+    std::memcpy(&index, indexData + i * sizeof(GLuint), sizeof(GLuint));
+    if (index >= vertexCount())
+      return false;
+  }
+
+  std::vector<MeshLod> lods(lodCount());
+  readLods(lods.data());
+  for (const MeshLod &lod : lods)
+    if (lod.firstIndex > indexCount() ||
+        lod.indexCount > indexCount() - lod.firstIndex)
+      return false;
+  return true;
+}
+
+size_t MeshCacheReader::vertexCount() const {
+  return static_cast<size_t>(header_->vertexCount);
+}
+
+size_t MeshCacheReader::indexCount() const {
+  return static_cast<size_t>(header_->indexCount);
+}
+
+Bounds MeshCacheReader::bounds() const {
+  Bounds bounds;
+  for (int i = 0; i < 3; ++i) {
+    bounds.box.min[i] = header_->boxMin[i];
+    bounds.box.max[i] = header_->boxMax[i];
+    bounds.sphere.center[i] = header_->sphereCenter[i];
+  }
+  bounds.sphere.radius = header_->sphereRadius;
+  return bounds;
+}
+
+void MeshCacheReader::readVertices(Vertex3D *dst) const {
+  std::memcpy(dst, file_.data() + sizeof(MeshCacheHeader),
+              vertexCount() * sizeof(Vertex3D));
+}
+
+void MeshCacheReader::readIndices(GLuint *dst) const {
+  std::memcpy(dst,
+              file_.data() + sizeof(MeshCacheHeader) +
+                  vertexCount() * sizeof(Vertex3D),
+              indexCount() * sizeof(GLuint));
+}
+
+size_t MeshCacheReader::lodCount() const { return header_->lodCount; }
+
+void MeshCacheReader::readLods(MeshLod *dst) const {
+  std::memcpy(dst,
+              file_.data() + sizeof(MeshCacheHeader) +
+                  vertexCount() * sizeof(Vertex3D) +
+                  indexCount() * sizeof(GLuint),
+              lodCount() * sizeof(MeshLod));
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <glbinding/gl/gl.h>
+
+#include "mapped_file.hpp"
+#include "mesh.hpp"
+
+struct MeshCacheHeader;
+
+// Chemin du fichier de cache associé à un fichier .ply (à côté de celui-ci).
+std::string meshCachePath(const char *plyPath);
+
+// Écrit le cache du maillage décodé depuis plyPath avec les options
+// identifiées par optionsKey (MeshLoadOptions::cacheKey()). Retourne false si
+// le fichier n'a pas pu être écrit; le chargement fonctionne alors sans cache.
+bool writeMeshCache(const char *plyPath, const MeshData &mesh,
+                    uint32_t optionsKey);
+
+// Lecture d'un cache de maillage décodé et traité.
+//
+// Le cache contient les sommets entrelacés en float, les indices sur 32 bits,
+// les niveaux de détail et les volumes englobants, précédés d'un en-tête
+// versionné qui identifie le fichier .ply source par sa taille, sa date de
+// modification et un hachage de son contenu. Le hachage n'est vérifié que si
+// la date ne suffit pas à exclure une modification (voir open()).
+// open() refuse un cache absent, d'une autre version, produit avec d'autres
+// options ou dont la source a changé. Offre la même interface de lecture que
+// PlyMeshReader, les données étant copiées depuis le fichier projeté en
+// mémoire; la quantification des sommets et le type d'indice du modèle sont
+// appliqués ensuite, au transfert.
+class MeshCacheReader {
+public:
+  bool open(const char *plyPath, uint32_t optionsKey);
+
+  size_t vertexCount() const;
+
+  size_t indexCount() const;
+
+  Bounds bounds() const;
+
+  void readVertices(Vertex3D *dst) const;
+
+  void readIndices(gl::GLuint *dst) const;
+
+  size_t lodCount() const;
+
+  void readLods(MeshLod *dst) const;
+
+private:
+  // Vrai si tous les indices désignent un sommet et si chaque niveau de
+  // détail reste dans les indices.
+  bool hasValidIndices() const;
+
+  MappedFile file_;
+  const MeshCacheHeader *header_ = nullptr;
+};
@@ -0,0 +1,301 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+using namespace gl;
+
+namespace {
+
+// Paramètres de Forsyth: cache LRU simulée et poids du score d'un sommet.
+constexpr int FORSYTH_CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+// Score d'un sommet selon sa position dans la cache (-1 si absent) et le
+// nombre de triangles pas encore émis qui l'utilisent.
+float vertexScore(int cachePosition, unsigned remainingValence) {
+  if (remainingValence == 0)
+    return -1.0f;
+
+  float score = 0.0f;
+  if (cachePosition >= 0) {
+    // Les sommets du dernier triangle ont un score fixe, pour ne pas favoriser
+    // l'émission d'un triangle qui réutilise ce même triangle.
+    if (cachePosition < 3) {
+      score = LAST_TRIANGLE_SCORE;
+    } else {
+      const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+      score = std::pow(1.0f - (cachePosition - 3) * scaler,
+                       CACHE_DECAY_POWER);
+    }
+  }
+  // Favorise les sommets presque terminés, pour ne pas laisser de triangles
+  // isolés à la fin.
+  score += VALENCE_BOOST_SCALE *
+           std::pow(static_cast<float>(remainingValence),
+                    -VALENCE_BOOST_POWER);
+  return score;
+}
+
+// Clé de hachage d'un sommet: ses octets, -0 étant ramené à 0 pour que les
+// deux zéros soient fusionnés.
+struct VertexKey {
+  float values[6];
+
+  explicit VertexKey(const Vertex3D &v)
+      : values{v.position.x + 0.0f, v.position.y + 0.0f,
+               v.position.z + 0.0f, v.color.r + 0.0f,
+               v.color.g + 0.0f,    v.color.b + 0.0f} {}
+
+  bool operator==(const VertexKey &other) const {
+    return std::memcmp(values, other.values, sizeof(values)) == 0;
+  }
+};
+
+struct VertexKeyHash {
+  size_t operator()(const VertexKey &key) const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (float value : key.values) {
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      hash = (hash ^ bits) * 0x100000001b3ull;
+    }
+    return static_cast<size_t>(hash ^ (hash >> 32));
+  }
+};
+
+} // namespace
+
+size_t weldVertices(MeshData &mesh) {
+  std::unordered_map<VertexKey, GLuint, VertexKeyHash> unique;
+  unique.reserve(mesh.vertices.size());
+  std::vector<GLuint> remap(mesh.vertices.size());
+  std::vector<Vertex3D> vertices;
+  vertices.reserve(mesh.vertices.size());
+  for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+    auto [it, isNew] = unique.try_emplace(
+        VertexKey(mesh.vertices[v]), static_cast<GLuint>(vertices.size()));
+    if (isNew)
+      vertices.push_back(mesh.vertices[v]);
+    remap[v] = it->second;
+  }
+
+  size_t removed = mesh.vertices.size() - vertices.size();
+  if (removed == 0)
+    return 0;
+  for (GLuint &index : mesh.indices)
+    if (index < remap.size())
+      index = remap[index];
+  mesh.vertices = std::move(vertices);
+  return removed;
+}
+
+size_t removeDegenerateTriangles(MeshData &mesh) {
+  const size_t vertexCount = mesh.vertices.size();
+  size_t kept = 0;
+  for (size_t t = 0; t + 3 <= mesh.indices.size(); t += 3) {
+    GLuint a = mesh.indices[t], b = mesh.indices[t + 1],
+           c = mesh.indices[t + 2];
+    bool isDegenerate = a == b || b == c || a == c;
+    if (!isDegenerate && a < vertexCount && b < vertexCount &&
+        c < vertexCount) {
+      const glm::vec3 &pa = mesh.vertices[a].position;
+      glm::vec3 normal = glm::cross(mesh.vertices[b].position - pa,
+                                    mesh.vertices[c].position - pa);
+      isDegenerate = normal == glm::vec3(0.0f);
+    }
+    if (!isDegenerate) {
+      mesh.indices[kept++] = a;
+      mesh.indices[kept++] = b;
+      mesh.indices[kept++] = c;
+    }
+  }
+  size_t removed = (mesh.indices.size() - kept) / 3;
+  mesh.indices.resize(kept);
+  return removed;
+}
+
+size_t removeUnusedVertices(MeshData &mesh) {
+  const GLuint UNUSED = std::numeric_limits<GLuint>::max();
+  std::vector<GLuint> remap(mesh.vertices.size(), UNUSED);
+  for (GLuint index : mesh.indices) {
+    if (index >= remap.size())
+      return 0;
+    remap[index] = 0;
+  }
+
+  GLuint next = 0;
+  for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+    if (remap[v] == UNUSED)
+      continue;
+    remap[v] = next;
+    mesh.vertices[next++] = mesh.vertices[v];
+  }
+  size_t removed = mesh.vertices.size() - next;
+  if (removed == 0)
+    return 0;
+  for (GLuint &index : mesh.indices)
+    index = remap[index];
+  mesh.vertices.resize(next);
+  return removed;
+}
+
+float computeACMR(const GLuint *indices, size_t indexCount,
+                  size_t vertexCount, size_t cacheSize) {
+  if (indexCount < 3)
+    return 0.0f;
+
+  // Cache FIFO: un sommet est présent si son horodatage d'entrée est assez
+  // récent.
+  std::vector<size_t> entry(vertexCount, 0);
+  size_t time = cacheSize + 1, misses = 0;
+  for (size_t i = 0; i < indexCount; ++i) {
+    GLuint v = indices[i];
+    if (v >= vertexCount)
+      continue;
+    if (time - entry[v] > cacheSize) {
+      entry[v] = time++;
+      ++misses;
+    }
+  }
+  return static_cast<float>(misses) / (indexCount / 3);
+}
+
+void optimizeVertexCache(GLuint *indices, size_t indexCount,
+                         size_t vertexCount) {
+  const size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0)
+    return;
+
+  // Triangles adjacents à chaque sommet, en tableau compact.
+  std::vector<unsigned> valence(vertexCount, 0);
+  for (size_t i = 0; i < indexCount; ++i)
+    ++valence[indices[i]];
+  std::vector<size_t> adjacencyStart(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; ++v)
+    adjacencyStart[v + 1] = adjacencyStart[v] + valence[v];
+  std::vector<size_t> adjacency(indexCount);
+  std::vector<size_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+  for (size_t i = 0; i < indexCount; ++i)
+    adjacency[fill[indices[i]]++] = i / 3;
+
+  std::vector<int> cachePosition(vertexCount, -1);
+  std::vector<float> score(vertexCount);
+  for (size_t v = 0; v < vertexCount; ++v)
+    score[v] = vertexScore(-1, valence[v]);
+  std::vector<float> triangleScore(triangleCount);
+  for (size_t t = 0; t < triangleCount; ++t)
+    triangleScore[t] = score[indices[3 * t]] + score[indices[3 * t + 1]] +
+                       score[indices[3 * t + 2]];
+  std::vector<bool> isEmitted(triangleCount, false);
+
+  std::vector<GLuint> cache, nextCache;
+  cache.reserve(FORSYTH_CACHE_SIZE + 3);
+  nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+  std::vector<GLuint> result;
+  result.reserve(indexCount);
+
+  size_t bestTriangle = 0, scanCursor = 0;
+  while (result.size() < indexCount) {
+    const GLuint *triangle = indices + 3 * bestTriangle;
+    result.insert(result.end(), triangle, triangle + 3);
+    isEmitted[bestTriangle] = true;
+
+    // Le triangle émis n'est plus adjacent à ses sommets.
+    for (int k = 0; k < 3; ++k) {
+      GLuint v = triangle[k];
+      size_t *first = adjacency.data() + adjacencyStart[v];
+      size_t *last = first + valence[v];
+      *std::find(first, last, bestTriangle) = *(last - 1);
+      --valence[v];
+    }
+
+    // Ses sommets passent en tête de la cache LRU.
+    nextCache.assign(triangle, triangle + 3);
+    for (GLuint v : cache)
+      if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+        nextCache.push_back(v);
+    for (size_t i = FORSYTH_CACHE_SIZE; i < nextCache.size(); ++i) {
+      cachePosition[nextCache[i]] = -1;
+      score[nextCache[i]] = vertexScore(-1, valence[nextCache[i]]);
+    }
+    nextCache.resize(std::min<size_t>(nextCache.size(), FORSYTH_CACHE_SIZE));
+    std::swap(cache, nextCache);
+
+    // Mise à jour des scores autour de la cache, en retenant le meilleur
+    // triangle candidat.
+    for (size_t i = 0; i < cache.size(); ++i) {
+      cachePosition[cache[i]] = static_cast<int>(i);
+      score[cache[i]] = vertexScore(static_cast<int>(i), valence[cache[i]]);
+    }
+    float bestScore = -1.0f;
+    for (GLuint v : cache) {
+      for (size_t a = adjacencyStart[v]; a < adjacencyStart[v] + valence[v];
+           ++a) {
+        size_t t = adjacency[a];
+        triangleScore[t] = score[indices[3 * t]] +
+                           score[indices[3 * t + 1]] +
+                           score[indices[3 * t + 2]];
+        if (triangleScore[t] > bestScore) {
+          bestScore = triangleScore[t];
+          bestTriangle = t;
+        }
+      }
+    }
+
+    // Aucun triangle ne touche la cache: on reprend au prochain triangle non
+    // émis, ce qui garde l'algorithme linéaire.
+    if (bestScore < 0.0f) {
+      while (scanCursor < triangleCount && isEmitted[scanCursor])
+        ++scanCursor;
+      bestTriangle = scanCursor;
+    }
+  }
+
+  std::copy(result.begin(), result.end(), indices);
+}
+
+void optimizeVertexFetch(MeshData &mesh) {
+  const GLuint UNASSIGNED = std::numeric_limits<GLuint>::max();
+  std::vector<GLuint> remap(mesh.vertices.size(), UNASSIGNED);
+  GLuint next = 0;
+  for (GLuint &index : mesh.indices) {
+    if (remap[index] == UNASSIGNED)
+      remap[index] = next++;
+    index = remap[index];
+  }
+  for (GLuint &newIndex : remap)
+    if (newIndex == UNASSIGNED)
+      newIndex = next++;
+
+  std::vector<Vertex3D> vertices(mesh.vertices.size());
+  for (size_t v = 0; v < mesh.vertices.size(); ++v)
+    vertices[remap[v]] = mesh.vertices[v];
+  mesh.vertices = std::move(vertices);
+}
+
+VertexOrderStats optimizeVertexOrder(MeshData &mesh) {
+  const size_t vertexCount = mesh.vertices.size();
+  VertexOrderStats stats;
+  stats.acmrBefore = stats.acmrAfter =
+      computeACMR(mesh.indices.data(), mesh.indices.size(), vertexCount);
+
+  if (mesh.indices.size() % 3 != 0 ||
+      std::any_of(mesh.indices.begin(), mesh.indices.end(),
+                  [&](GLuint index) { return index >= vertexCount; }))
+    return stats;
+
+  optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount);
+  optimizeVertexFetch(mesh);
+  stats.acmrAfter =
+      computeACMR(mesh.indices.data(), mesh.indices.size(), vertexCount);
+  return stats;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glbinding/gl/gl.h>
+
+#include "mesh.hpp"
+
+// Taille de la cache de sommets post-transformation simulée par
+// computeACMR() (FIFO, comme sur la plupart des cartes graphiques).
+constexpr size_t ACMR_CACHE_SIZE = 16;
+
+// Nombre moyen de sommets transformés par triangle (Average Cache Miss
+// Ratio): 3 sans aucune réutilisation, 0.5 au mieux pour un grand maillage
+// régulier.
+float computeACMR(const gl::GLuint *indices, size_t indexCount,
+                  size_t vertexCount, size_t cacheSize = ACMR_CACHE_SIZE);
+
+// Réordonne les triangles pour la localité dans la cache de sommets
+// (algorithme linéaire de Tom Forsyth). Les indices doivent décrire des
+// triangles.
+void optimizeVertexCache(gl::GLuint *indices, size_t indexCount,
+                         size_t vertexCount);
+
+// Réordonne les sommets dans l'ordre de leur première utilisation par les
+// indices, pour la localité des lectures du VBO. Les sommets inutilisés sont
+// placés à la fin.
+void optimizeVertexFetch(MeshData &mesh);
+
+// Fusionne les sommets identiques (même position et même couleur) par
+// hachage et renumérote les indices. Retourne le nombre de sommets retirés.
+size_t weldVertices(MeshData &mesh);
+
+// Retire les triangles dégénérés: deux indices égaux ou aire nulle. Retourne
+// le nombre de triangles retirés.
+size_t removeDegenerateTriangles(MeshData &mesh);
+
+// Retire les sommets qu'aucun indice n'utilise, sans changer l'ordre des
+// autres, et renumérote les indices. Ne fait rien si un indice dépasse les
+// sommets. Retourne le nombre de sommets retirés.
+size_t removeUnusedVertices(MeshData &mesh);
+
+struct VertexOrderStats {
+  float acmrBefore;
+  float acmrAfter;
+};
+
+// Les deux passes ci-dessus, dans l'ordre. Ne fait rien si les indices ne
+// forment pas des triangles.
+VertexOrderStats optimizeVertexOrder(MeshData &mesh);
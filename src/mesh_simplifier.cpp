@@ -0,0 +1,273 @@
+#include "mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mesh_optimizer.hpp"
+
+using namespace gl;
+
+namespace {
+
+// Poids des plans qui retiennent les bords, relatif à celui des triangles.
+constexpr double BOUNDARY_WEIGHT = 10.0;
+
+// Inverse de la part des arêtes candidates, les moins coûteuses, essayées à
+// chaque passe avant de recalculer les coûts.
+constexpr size_t PASS_FRACTION = 4;
+
+// Un niveau qui ne retire pas au moins ce facteur de triangles n'est pas
+// conservé.
+constexpr float MIN_LOD_REDUCTION = 0.9f;
+
+// Matrice 4x4 symétrique de l'erreur quadrique (somme pondérée des carrés des
+// distances à des plans), et somme des poids.
+struct Quadric {
+  double a2 = 0, ab = 0, ac = 0, ad = 0;
+  double b2 = 0, bc = 0, bd = 0;
+  double c2 = 0, cd = 0;
+  double d2 = 0;
+  double weight = 0;
+
+  Quadric() = default;
+
+  // Plan n.p + d = 0, n unitaire.
+  Quadric(const glm::dvec3 &n, double d, double w)
+      : a2(w * n.x * n.x), ab(w * n.x * n.y), ac(w * n.x * n.z),
+        ad(w * n.x * d), b2(w * n.y * n.y), bc(w * n.y * n.z),
+        bd(w * n.y * d), c2(w * n.z * n.z), cd(w * n.z * d), d2(w * d * d),
+        weight(w) {}
+
+  Quadric &operator+=(const Quadric &q) {
+    a2 += q.a2, ab += q.ab, ac += q.ac, ad += q.ad;
+    b2 += q.b2, bc += q.bc, bd += q.bd;
+    c2 += q.c2, cd += q.cd;
+    d2 += q.d2;
+    weight += q.weight;
+    return *this;
+  }
+
+  double evaluate(const glm::dvec3 &p) const {
+    double e = a2 * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z +
+               2 * ad * p.x + b2 * p.y * p.y + 2 * bc * p.y * p.z +
+               2 * bd * p.y + c2 * p.z * p.z + 2 * cd * p.z + d2;
+    return std::max(e, 0.0);
+  }
+};
+
+struct Collapse {
+  GLuint from, to;
+  double cost;
+};
+
+glm::dvec3 positionOf(const std::vector<Vertex3D> &vertices, GLuint v) {
+  return glm::dvec3(vertices[v].position);
+}
+
+// Quadriques initiales: plans des triangles, pondérés par leur aire, et plans
+// perpendiculaires aux arêtes de bord.
+std::vector<Quadric> computeQuadrics(const std::vector<Vertex3D> &vertices,
+                                     const std::vector<GLuint> &indices) {
+  std::vector<Quadric> quadrics(vertices.size());
+
+  // Arêtes orientées, triées pour trouver celles sans arête opposée.
+  std::vector<std::pair<GLuint, GLuint>> edges;
+  edges.reserve(indices.size());
+  for (size_t t = 0; t < indices.size(); t += 3)
+    for (int k = 0; k < 3; ++k)
+      edges.push_back({indices[t + k], indices[t + (k + 1) % 3]});
+  std::sort(edges.begin(), edges.end());
+
+  for (size_t t = 0; t < indices.size(); t += 3) {
+    glm::dvec3 p[3];
+    for (int k = 0; k < 3; ++k)
+      p[k] = positionOf(vertices, indices[t + k]);
+    glm::dvec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+    double doubleArea = glm::length(normal);
+    if (doubleArea <= 0.0)
+      continue;
+    normal /= doubleArea;
+
+    Quadric plane(normal, -glm::dot(normal, p[0]), doubleArea * 0.5);
+    for (int k = 0; k < 3; ++k)
+      quadrics[indices[t + k]] += plane;
+
+    for (int k = 0; k < 3; ++k) {
+      GLuint a = indices[t + k], b = indices[t + (k + 1) % 3];
+      if (std::binary_search(edges.begin(), edges.end(),
+                             std::make_pair(b, a)))
+        continue;
+      glm::dvec3 edge = p[(k + 1) % 3] - p[k];
+      glm::dvec3 side = glm::cross(edge, normal);
+      double length = glm::length(side);
+      if (length <= 0.0)
+        continue;
+      side /= length;
+      Quadric border(side, -glm::dot(side, p[k]),
+                     BOUNDARY_WEIGHT * glm::dot(edge, edge));
+      quadrics[a] += border;
+      quadrics[b] += border;
+    }
+  }
+  return quadrics;
+}
+
+// Vrai si déplacer from sur to retourne (ou aplatit) un des triangles
+// [first, last) de from qui ne contient pas to.
+bool flipsTriangle(const std::vector<Vertex3D> &vertices,
+                   const std::vector<GLuint> &indices, const size_t *first,
+                   const size_t *last, GLuint from, GLuint to) {
+  for (const size_t *t = first; t != last; ++t) {
+    const GLuint *tri = &indices[3 * *t];
+    if (tri[0] == to || tri[1] == to || tri[2] == to)
+      continue;
+    glm::dvec3 before[3], after[3];
+    for (int k = 0; k < 3; ++k) {
+      before[k] = positionOf(vertices, tri[k]);
+      after[k] = tri[k] == from ? positionOf(vertices, to) : before[k];
+    }
+    glm::dvec3 oldNormal =
+        glm::cross(before[1] - before[0], before[2] - before[0]);
+    glm::dvec3 newNormal = glm::cross(after[1] - after[0], after[2] - after[0]);
+    if (glm::dot(oldNormal, newNormal) <= 0.0)
+      return true;
+  }
+  return false;
+}
+
+} // namespace
+
+std::vector<GLuint> simplifyMesh(const std::vector<Vertex3D> &vertices,
+                                 const std::vector<GLuint> &indices,
+                                 size_t targetIndexCount, float &error) {
+  error = 0.0f;
+  std::vector<GLuint> result = indices;
+  if (result.size() % 3 != 0)
+    return result;
+  for (GLuint index : result)
+    if (index >= vertices.size())
+      return result;
+
+  std::vector<Quadric> quadrics = computeQuadrics(vertices, result);
+  double maxError = 0.0;
+
+  while (result.size() > targetIndexCount) {
+    const size_t triangleCount = result.size() / 3;
+
+    // Triangles adjacents à chaque sommet.
+    std::vector<size_t> start(vertices.size() + 1, 0);
+    for (GLuint index : result)
+      ++start[index + 1];
+    for (size_t v = 0; v < vertices.size(); ++v)
+      start[v + 1] += start[v];
+    std::vector<size_t> adjacency(result.size());
+    std::vector<size_t> fill(start.begin(), start.end() - 1);
+    for (size_t i = 0; i < result.size(); ++i)
+      adjacency[fill[result[i]]++] = i / 3;
+
+    // Coût de chaque fusion, dans le sens le moins coûteux de l'arête (sur la
+    // position de la destination).
+    std::vector<Collapse> collapses;
+    collapses.reserve(result.size());
+    for (size_t t = 0; t < result.size(); t += 3) {
+      for (int k = 0; k < 3; ++k) {
+        GLuint a = result[t + k], b = result[t + (k + 1) % 3];
+        Quadric q = quadrics[a];
+        q += quadrics[b];
+        double toB = q.evaluate(positionOf(vertices, b));
+        double toA = q.evaluate(positionOf(vertices, a));
+        collapses.push_back(toB <= toA ? Collapse{a, b, toB}
+                                       : Collapse{b, a, toA});
+      }
+    }
+
+    // Seule la fraction la moins coûteuse est triée et essayée dans cette
+    // passe.
+    auto byCost = [](const Collapse &x, const Collapse &y) {
+      return x.cost < y.cost;
+    };
+    auto passEnd = collapses.begin() +
+                   std::max<size_t>(1, collapses.size() / PASS_FRACTION);
+    std::nth_element(collapses.begin(), passEnd - 1, collapses.end(), byCost);
+    std::sort(collapses.begin(), passEnd, byCost);
+    collapses.erase(passEnd, collapses.end());
+
+    // Fusions indépendantes: les sommets des triangles touchés sont
+    // verrouillés jusqu'à la passe suivante.
+    std::vector<GLuint> remap(vertices.size());
+    for (size_t v = 0; v < remap.size(); ++v)
+      remap[v] = static_cast<GLuint>(v);
+    std::vector<bool> isLocked(vertices.size(), false);
+    size_t remaining = triangleCount, nCollapses = 0;
+    for (const Collapse &c : collapses) {
+      if (remaining * 3 <= targetIndexCount)
+        break;
+      if (isLocked[c.from] || isLocked[c.to])
+        continue;
+      const size_t *first = adjacency.data() + start[c.from];
+      const size_t *last = adjacency.data() + start[c.from + 1];
+      if (flipsTriangle(vertices, result, first, last, c.from, c.to))
+        continue;
+
+      for (const size_t *t = first; t != last; ++t) {
+        const GLuint *tri = &result[3 * *t];
+        if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+          --remaining;
+        for (int k = 0; k < 3; ++k)
+          isLocked[tri[k]] = true;
+      }
+      remap[c.from] = c.to;
+      quadrics[c.to] += quadrics[c.from];
+      const Quadric &merged = quadrics[c.to];
+      if (merged.weight > 0.0)
+        maxError = std::max(maxError, c.cost / merged.weight);
+      ++nCollapses;
+    }
+    if (nCollapses == 0)
+      break;
+
+    // Application des fusions et retrait des triangles devenus dégénérés.
+    size_t kept = 0;
+    for (size_t t = 0; t < result.size(); t += 3) {
+      GLuint a = remap[result[t]], b = remap[result[t + 1]],
+             c = remap[result[t + 2]];
+      if (a == b || b == c || a == c)
+        continue;
+      result[kept++] = a;
+      result[kept++] = b;
+      result[kept++] = c;
+    }
+    result.resize(kept);
+  }
+
+  error = static_cast<float>(std::sqrt(maxError));
+  return result;
+}
+
+void generateLods(MeshData &mesh, unsigned levelCount, bool optimizeCache) {
+  const std::vector<GLuint> base = mesh.indices;
+  mesh.lods = {{0, static_cast<GLuint>(base.size()), 0.0f}};
+
+  size_t previousCount = base.size();
+  float previousError = 0.0f;
+  for (unsigned level = 1; level < levelCount; ++level) {
+    // Chaque niveau est simplifié depuis l'original pour ne pas cumuler
+    // l'erreur des niveaux précédents.
+    size_t target = std::max<size_t>(3, (base.size() / 3 >> level) * 3);
+    float error;
+    std::vector<GLuint> indices =
+        simplifyMesh(mesh.vertices, base, target, error);
+    if (indices.empty() ||
+        indices.size() > previousCount * MIN_LOD_REDUCTION)
+      break;
+    if (optimizeCache)
+      optimizeVertexCache(indices.data(), indices.size(),
+                          mesh.vertices.size());
+
+    previousError = std::max(previousError, error);
+    mesh.lods.push_back({static_cast<GLuint>(mesh.indices.size()),
+                         static_cast<GLuint>(indices.size()), previousError});
+    mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+    previousCount = indices.size();
+  }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glbinding/gl/gl.h>
+
+#include "mesh.hpp"
+
+// Simplifie les triangles de indices par fusion d'arêtes guidée par l'erreur
+// quadrique (Garland et Heckbert), jusqu'à au plus targetIndexCount indices
+// si possible. Les sommets ne sont jamais déplacés: chaque arête est fusionnée
+// sur l'une de ses extrémités, si bien que le résultat réutilise le même VBO.
+// Les bords du maillage (dont les coutures de couleur) sont pénalisés pour
+// rester en place, et les fusions qui retourneraient un triangle sont
+// refusées.
+//
+// error reçoit la plus grande distance estimée, en unités du modèle, entre la
+// surface simplifiée et l'originale.
+std::vector<gl::GLuint> simplifyMesh(const std::vector<Vertex3D> &vertices,
+                                     const std::vector<gl::GLuint> &indices,
+                                     size_t targetIndexCount, float &error);
+
+// Ajoute à mesh jusqu'à levelCount - 1 niveaux de détail, chacun avec environ
+// deux fois moins de triangles que le précédent. Les indices de chaque niveau
+// sont ajoutés à la suite de mesh.indices. S'arrête plus tôt si le maillage
+// ne se simplifie plus. Si optimizeCache est vrai, chaque niveau est
+// réordonné pour la cache de sommets.
+void generateLods(MeshData &mesh, unsigned levelCount, bool optimizeCache);
@@ -1,84 +1,413 @@
 #include "model.hpp"
 
+#include "gl_state.hpp"
 #include "happly.h"
+#include "mesh.hpp"
+#include "mesh_cache.hpp"
+#include "mesh_optimizer.hpp"
+#include "mesh_simplifier.hpp"
+#include "ply_reader.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 using namespace gl;
 
-struct Vertex3D {
-  glm::vec3 position;
-  glm::vec3 color;
+size_t indexTypeSize(GLenum indexType) {
+  switch (indexType) {
+  case GL_UNSIGNED_BYTE:
+    return sizeof(GLubyte);
+  case GL_UNSIGNED_SHORT:
+    return sizeof(GLushort);
+  default:
+    return sizeof(GLuint);
+  }
+}
+
+namespace {
+
+// Accès direct au tableau d'une propriété happly, sans la copie faite par
+// getProperty<T>(). Si la propriété n'a pas exactement le type T, on se rabat
+// sur getProperty<T>(), qui convertit ou lance l'erreur appropriée.
+template <typename T>
+const std::vector<T> &propertyData(happly::Element &element,
+                                   const std::string &name,
+                                   std::vector<T> &storage) {
+  auto *typed = dynamic_cast<happly::TypedProperty<T> *>(
+      element.getPropertyPtr(name).get());
+  if (typed)
+    return typed->data;
+  storage = element.getProperty<T>(name);
+  return storage;
+}
+
+// Chargement générique par happly, utilisé pour les fichiers ASCII ou dont la
+// disposition n'est pas prise en charge par PlyMeshReader. Offre la même
+// interface que PlyMeshReader.
+class HapplyMeshReader {
+public:
+  explicit HapplyMeshReader(const char *path) : plyIn_(path) {
+    const char *const POSITION_NAMES[] = {"x", "y", "z"};
+    const char *const COLOR_NAMES[] = {"red", "green", "blue"};
+    happly::Element &vertex = plyIn_.getElement("vertex");
+    for (int i = 0; i < 3; ++i) {
+      positions_[i] =
+          &propertyData(vertex, POSITION_NAMES[i], positionStorage_[i]);
+      colors_[i] = &propertyData(vertex, COLOR_NAMES[i], colorStorage_[i]);
+    }
+
+    // Indices de toutes les faces mis bout à bout. Les faces sont toutes des
+    // triangles dans nos modèles (3 indices par face).
+    std::vector<size_t> faceStarts;
+    facesIndices_ = plyIn_.getFaceIndicesFlat<unsigned int>(faceStarts);
+  }
+
+  size_t vertexCount() const { return positions_[0]->size(); }
+
+  size_t indexCount() const { return facesIndices_.size(); }
+
+  void readVertices(Vertex3D *dst) const {
+    const std::vector<float> &x = *positions_[0], &y = *positions_[1],
+                             &z = *positions_[2];
+    const std::vector<unsigned char> &r = *colors_[0], &g = *colors_[1],
+                                     &b = *colors_[2];
+    for (size_t i = 0; i < x.size(); ++i)
+      dst[i] = {{x[i], y[i], z[i]},
+                {r[i] / 255.0f, g[i] / 255.0f, b[i] / 255.0f}};
+  }
+
+  void readIndices(GLuint *dst) const {
+    std::copy(facesIndices_.begin(), facesIndices_.end(), dst);
+  }
+
+private:
+  happly::PLYData plyIn_;
+  const std::vector<float> *positions_[3];
+  const std::vector<unsigned char> *colors_[3];
+  std::vector<float> positionStorage_[3];
+  std::vector<unsigned char> colorStorage_[3];
+  std::vector<unsigned int> facesIndices_;
 };
 
-void Model::load(const char *path) {
-  // Chargement des données du fichier .ply.
-  // Ne modifiez pas cette partie.
-  happly::PLYData plyIn(path);
-
-  happly::Element &vertex = plyIn.getElement("vertex");
-  std::vector<float> positionX = vertex.getProperty<float>("x");
-  std::vector<float> positionY = vertex.getProperty<float>("y");
-  std::vector<float> positionZ = vertex.getProperty<float>("z");
-
-  std::vector<unsigned char> colorRed =
-      vertex.getProperty<unsigned char>("red");
-  std::vector<unsigned char> colorGreen =
-      vertex.getProperty<unsigned char>("green");
-  std::vector<unsigned char> colorBlue =
-      vertex.getProperty<unsigned char>("blue");
-
-  // Tableau de faces, une face est un tableau d'indices.
-  // Les faces sont toutes des triangles dans nos modèles (3 indices par face).
-  std::vector<std::vector<unsigned int>> facesIndices =
-      plyIn.getFaceIndices<unsigned int>();
-
-  // Rassembler les propriétés
-  std::vector<Vertex3D> vertices(positionX.size());
-  for (size_t i = 0; i < positionX.size(); ++i) {
-    vertices[i] = {
-        {positionX[i], positionY[i], positionZ[i]},
-        {colorRed[i] / 255.0f, colorGreen[i] / 255.0f, colorBlue[i] / 255.0f}};
+// Alloue le tampon lié à target et le remplit en écrivant directement dans sa
+// projection, sans tableau intermédiaire côté CPU.
+template <typename T, typename Fill>
+void fillMappedBuffer(GLenum target, size_t count, Fill fill) {
+  GLsizeiptr size = static_cast<GLsizeiptr>(count * sizeof(T));
+  glBufferData(target, size, nullptr, GL_STATIC_DRAW);
+  if (count == 0)
+    return;
+  // glUnmapBuffer peut échouer si le contenu a été perdu entre-temps (ex.
+  // changement de mode d'affichage); on recommence alors l'écriture.
+  for (;;) {
+    void *dst = glMapBufferRange(
+        target, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst == nullptr)
+      break;
+    fill(static_cast<T *>(dst));
+    if (glUnmapBuffer(target) == GL_TRUE)
+      return;
   }
 
-  // Rassembler les indices pour le EBO.
-  std::vector<GLuint> indices;
-  for (const auto &face : facesIndices) {
-    for (unsigned int idx : face) {
-      indices.push_back(idx);
-    }
+  // La projection a échoué: on passe par un tableau temporaire.
+  std::vector<T> staging(count);
+  fill(staging.data());
+  glBufferSubData(target, 0, size, staging.data());
+}
+
+// Type d'indice le plus étroit qui permet d'adresser vertexCount sommets.
+GLenum narrowestIndexType(size_t vertexCount) {
+  if (vertexCount <= 0x100)
+    return GL_UNSIGNED_BYTE;
+  if (vertexCount <= 0x10000)
+    return GL_UNSIGNED_SHORT;
+  return GL_UNSIGNED_INT;
+}
+
+// Appelle visit avec une valeur du type C++ qui correspond à indexType.
+template <typename Visit> void visitIndexType(GLenum indexType, Visit visit) {
+  switch (indexType) {
+  case GL_UNSIGNED_BYTE:
+    visit(GLubyte());
+    break;
+  case GL_UNSIGNED_SHORT:
+    visit(GLushort());
+    break;
+  default:
+    visit(GLuint());
+    break;
   }
+}
 
-  // Initialisation du nombre d'indices à dessiner.
-  count_ = static_cast<GLsizei>(indices.size());
+template <typename Index>
+void narrowIndices(const GLuint *src, size_t count, Index *dst) {
+  std::transform(src, src + count, dst,
+                 [](GLuint index) { return static_cast<Index>(index); });
+}
 
+// Lit les indices de reader dans dst, convertis vers le type Index.
+template <typename Reader, typename Index>
+void readIndicesAs(const Reader &reader, Index *dst) {
+  if constexpr (std::is_same_v<Index, GLuint>) {
+    reader.readIndices(dst);
+  } else {
+    std::vector<GLuint> indices(reader.indexCount());
+    reader.readIndices(indices.data());
+    narrowIndices(indices.data(), indices.size(), dst);
+  }
+}
+
+// Traitements optionnels du maillage, faits une seule fois avant l'écriture
+// du cache.
+void process(const char *path, MeshData &mesh,
+             const MeshLoadOptions &options) {
+  // Le rapport est écrit d'un coup, les modèles pouvant être lus en
+  // parallèle.
+  std::ostringstream report;
+  if (options.weldVertices) {
+    size_t nVertices = mesh.vertices.size(),
+           nTriangles = mesh.indices.size() / 3;
+    size_t weldedVertices = weldVertices(mesh);
+    size_t degenerateTriangles = removeDegenerateTriangles(mesh);
+    // Les sommets qui ne servaient qu'aux triangles retirés ne sont plus
+    // transférés.
+    size_t unusedVertices = removeUnusedVertices(mesh);
+    report << "Model \"" << path << "\": welded " << weldedVertices << "/"
+           << nVertices << " vertices, removed " << degenerateTriangles << "/"
+           << nTriangles << " degenerate triangles and " << unusedVertices
+           << " unused vertices\n";
+  }
+  if (options.optimizeVertexOrder) {
+    VertexOrderStats stats = optimizeVertexOrder(mesh);
+    report << "Model \"" << path << "\": ACMR " << stats.acmrBefore
+           << " -> " << stats.acmrAfter << '\n';
+  }
+  if (options.lodLevels > 1) {
+    generateLods(mesh, options.lodLevels, options.optimizeVertexOrder);
+    report << "Model \"" << path << "\": LOD triangles";
+    for (const MeshLod &lod : mesh.lods)
+      report << " " << lod.indexCount / 3;
+    report << '\n';
+  }
+  std::cout << report.str() << std::flush;
+}
+
+// Emplacements des uniformes de déquantification, partagés par tous les
+// modèles.
+struct DequantizationUniforms {
+  GLint scaleLocation = -1;
+  GLint offsetLocation = -1;
+} dequantizationUniforms;
+
+// Erreur projetée tolérée pour choisir un niveau de détail, en unités NDC.
+float lodTolerance = 2.0f / 600.0f;
+
+// Emplacement de l'uniforme du numéro de la matrice de modèle.
+GLint objectIndexLocation = -1;
+
+} // namespace
+
+template <typename Reader> void Model::upload(const Reader &reader) {
+  // Plages d'indices à dessiner pour chaque niveau de détail.
+  lods_.resize(reader.lodCount());
+  reader.readLods(lods_.data());
+  vertexCount_ = reader.vertexCount();
+  indexCount_ = reader.indexCount();
+
+  createBuffers();
+
+  // Remplissage du VBO. Les sommets en float sont décodés directement dans le
+  // tampon; les sommets quantifiés passent par un tableau temporaire.
+  GlStateCache::bindBuffer(GL_ARRAY_BUFFER, vbo_);
+  dequantization_ = {};
+  if (vertexFormat_ == VertexFormat::Quantized) {
+    std::vector<Vertex3D> vertices(reader.vertexCount());
+    reader.readVertices(vertices.data());
+    fillMappedBuffer<QuantizedVertex3D>(
+        GL_ARRAY_BUFFER, vertices.size(), [&](QuantizedVertex3D *dst) {
+          dequantization_ =
+              quantizeVertices(vertices.data(), vertices.size(), dst);
+        });
+  } else {
+    fillMappedBuffer<Vertex3D>(
+        GL_ARRAY_BUFFER, reader.vertexCount(),
+        [&](Vertex3D *dst) { reader.readVertices(dst); });
+  }
+
+  // Remplissage du EBO, avec le type d'indice le plus étroit possible.
+  indexType_ = narrowestIndexType(reader.vertexCount());
+  GlStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+  visitIndexType(indexType_, [&](auto index) {
+    using Index = decltype(index);
+    fillMappedBuffer<Index>(GL_ELEMENT_ARRAY_BUFFER, reader.indexCount(),
+                            [&](Index *dst) { readIndicesAs(reader, dst); });
+  });
+
+  setVertexAttributes(vertexFormat_);
+  GlStateCache::bindVertexArray(0);
+}
+
+void Model::createBuffers() {
   // Allocation des ressources sur la carte graphique (VBO, EBO, VAO).
   glGenBuffers(1, &vbo_);
   glGenBuffers(1, &ebo_);
   glGenVertexArrays(1, &vao_);
 
   // Liaison du VAO
-  glBindVertexArray(vao_);
+  GlStateCache::bindVertexArray(vao_);
+}
 
-  // Remplissage du VBO
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex3D),
-               vertices.data(), GL_STATIC_DRAW);
+void Model::setVertexAttributes(VertexFormat format) {
+  if (format == VertexFormat::Quantized) {
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(QuantizedVertex3D),
+                          (void *)offsetof(QuantizedVertex3D, position));
+    glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE,
+                          sizeof(QuantizedVertex3D),
+                          (void *)offsetof(QuantizedVertex3D, color));
+  } else {
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3D),
+                          (void *)0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3D),
+                          (void *)sizeof(glm::vec3));
+  }
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+}
 
-  // Remplissage du EBO
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint),
-               indices.data(), GL_STATIC_DRAW);
+MeshData Model::read(const char *path, const MeshLoadOptions &options) {
+  MeshData mesh;
+  auto decode = [&](const auto &reader) {
+    mesh.vertices.resize(reader.vertexCount());
+    mesh.indices.resize(reader.indexCount());
+    reader.readVertices(mesh.vertices.data());
+    reader.readIndices(mesh.indices.data());
+  };
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (void *)0);
-  glEnableVertexAttribArray(0);
+  MeshCacheReader cache;
+  if (cache.open(path, options.cacheKey())) {
+    decode(cache);
+    mesh.lods.resize(cache.lodCount());
+    cache.readLods(mesh.lods.data());
+    mesh.bounds = cache.bounds();
+    return mesh;
+  }
 
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3D),
-                        (void *)sizeof(glm::vec3));
-  glEnableVertexAttribArray(1);
+  // Décodage du fichier .ply. Les fichiers binaires little-endian sont
+  // décodés directement depuis le fichier projeté en mémoire; les autres
+  // passent par happly.
+  PlyMeshReader reader;
+  if (reader.open(path))
+    decode(reader);
+  else
+    decode(HapplyMeshReader(path));
+  mesh.computeBounds();
+  process(path, mesh, options);
+
+  writeMeshCache(path, mesh, options.cacheKey());
+  return mesh;
+}
 
-  glBindVertexArray(0);
+void Model::load(const char *path) {
+  // Un cache valide évite le décodage et les traitements du maillage. Il
+  // garde toutefois les sommets en float et les indices sur 32 bits:
+  // upload() les quantifie et les rétrécit encore selon le format du modèle.
+  MeshCacheReader cache;
+  if (cache.open(path, loadOptions_.cacheKey())) {
+    bounds_ = cache.bounds();
+    upload(cache);
+    return;
+  }
+
+  // Les très gros fichiers ne sont jamais chargés en entier en mémoire.
+  std::error_code error;
+  if (std::filesystem::file_size(path, error) >= STREAMING_MIN_FILE_SIZE &&
+      !error && loadStreamed(path))
+    return;
+
+  upload(read(path, loadOptions_));
+}
+
+bool Model::loadStreamed(const char *path, size_t chunkBytes) {
+  PlyStreamReader reader(chunkBytes);
+  if (!reader.open(path))
+    return false;
+
+  // Les positions ne peuvent pas être quantifiées sans connaître d'avance la
+  // boîte englobante: les gros fichiers restent en float.
+  vertexFormat_ = VertexFormat::Float;
+  dequantization_ = {};
+  lods_ = {{0, static_cast<GLuint>(reader.indexCount()), 0.0f}};
+  vertexCount_ = reader.vertexCount();
+  indexCount_ = reader.indexCount();
+  createBuffers();
+
+  // Chaque morceau décodé est transféré aussitôt, puis réutilisé. La boîte
+  // englobante est accumulée au passage; la sphère, qui demanderait un
+  // second passage, est celle qui englobe la boîte.
+  bool isComplete = true;
+  GlStateCache::bindBuffer(GL_ARRAY_BUFFER, vbo_);
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(reader.vertexCount() * sizeof(Vertex3D)),
+               nullptr, GL_STATIC_DRAW);
+  bounds_ = {};
+  isComplete &= reader.readVertices(
+      [&](size_t first, const Vertex3D *vertices, size_t count) {
+        BoundingBox chunk = computeBoundingBox(vertices, count);
+        bounds_.box.min = first == 0 ? chunk.min
+                                     : glm::min(bounds_.box.min, chunk.min);
+        bounds_.box.max = first == 0 ? chunk.max
+                                     : glm::max(bounds_.box.max, chunk.max);
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        static_cast<GLintptr>(first * sizeof(Vertex3D)),
+                        static_cast<GLsizeiptr>(count * sizeof(Vertex3D)),
+                        vertices);
+      });
+  bounds_.sphere = enclosingSphere(bounds_.box);
+
+  indexType_ = narrowestIndexType(reader.vertexCount());
+  GlStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(reader.indexCount() *
+                                       indexTypeSize(indexType_)),
+               nullptr, GL_STATIC_DRAW);
+  visitIndexType(indexType_, [&](auto index) {
+    using Index = decltype(index);
+    std::vector<Index> narrowed;
+    isComplete &= reader.readIndices(
+        [&](size_t first, const GLuint *indices, size_t count) {
+          const void *data = indices;
+          if constexpr (!std::is_same_v<Index, GLuint>) {
+            narrowed.resize(count);
+            narrowIndices(indices, count, narrowed.data());
+            data = narrowed.data();
+          }
+          glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                          static_cast<GLintptr>(first * sizeof(Index)),
+                          static_cast<GLsizeiptr>(count * sizeof(Index)),
+                          data);
+        });
+  });
+
+  setVertexAttributes(vertexFormat_);
+  GlStateCache::bindVertexArray(0);
+  if (!isComplete)
+    throw std::runtime_error("PLY file \"" + std::string(path) +
+                             "\" is truncated.");
+  return true;
+}
+
+void Model::load(const MeshData &mesh) {
+  bounds_ = mesh.bounds;
+  upload(mesh);
 }
 
 Model::~Model() {
@@ -87,8 +416,115 @@ Model::~Model() {
   glDeleteBuffers(1, &ebo_);
 }
 
-void Model::draw() const {
-  glBindVertexArray(vao_);
-  glDrawElements(GL_TRIANGLES, count_, GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
+void Model::setVertexFormat(VertexFormat format) { vertexFormat_ = format; }
+
+void Model::setLoadOptions(const MeshLoadOptions &options) {
+  loadOptions_ = options;
+}
+
+void Model::setDequantizationUniforms(GLint scaleLocation,
+                                      GLint offsetLocation) {
+  dequantizationUniforms.scaleLocation = scaleLocation;
+  dequantizationUniforms.offsetLocation = offsetLocation;
+}
+
+void Model::setObjectIndexUniform(GLint location) {
+  objectIndexLocation = location;
+}
+
+void Model::setLodTolerance(float ndcTolerance) {
+  lodTolerance = ndcTolerance;
+}
+
+size_t Model::selectLod(const glm::mat4 &projView,
+                        const Bounds &worldBounds) const {
+  if (lods_.size() <= 1)
+    return 0;
+
+  // Distance de la caméra au point le plus proche de la sphère englobante.
+  // Une instance qui touche le plan de la caméra garde le niveau le plus fin.
+  const BoundingSphere &sphere = worldBounds.sphere;
+  float distance =
+      (projView * glm::vec4(sphere.center, 1.0f)).w - sphere.radius;
+  if (distance <= 0.0f)
+    return 0;
+
+  // NDC par unité du modèle à cette distance: échelle de la projection
+  // (NDC par unité du monde à une distance de 1) multipliée par l'échelle de
+  // l'instance.
+  float projectionScale = 0.0f;
+  for (int axis = 0; axis < 3; ++axis)
+    projectionScale =
+        std::max(projectionScale, glm::length(glm::vec2(projView[axis])));
+  float instanceScale = bounds_.sphere.radius > 0.0f
+                            ? sphere.radius / bounds_.sphere.radius
+                            : 1.0f;
+  const float ndcPerUnit = projectionScale * instanceScale / distance;
+
+  // Niveau le plus grossier dont l'erreur projetée reste tolérable.
+  for (size_t lod = lods_.size() - 1; lod > 0; --lod)
+    if (lods_[lod].error * ndcPerUnit <= lodTolerance)
+      return lod;
+  return 0;
+}
+
+void Model::bind() const {
+  // Les modèles successifs ont souvent le même format, et les instances d'un
+  // modèle le même VAO: GlStateCache évite les appels identiques.
+  GlStateCache::uniform(dequantizationUniforms.scaleLocation,
+                        dequantization_.scale);
+  GlStateCache::uniform(dequantizationUniforms.offsetLocation,
+                        dequantization_.offset);
+  GlStateCache::bindVertexArray(vao_);
+}
+
+GLsizeiptr Model::vertexBufferSize() const {
+  size_t vertexSize = vertexFormat_ == VertexFormat::Quantized
+                          ? sizeof(QuantizedVertex3D)
+                          : sizeof(Vertex3D);
+  return static_cast<GLsizeiptr>(vertexCount_ * vertexSize);
+}
+
+GLsizeiptr Model::indexBufferSize() const {
+  return static_cast<GLsizeiptr>(indexCount_ * indexTypeSize(indexType_));
+}
+
+void Model::copyBuffers(GLuint vbo, GLintptr vertexOffset, GLuint ebo,
+                        GLintptr indexOffset) const {
+  // Copie entre tampons sur la carte graphique, sans passer par le CPU.
+  auto copy = [](GLuint source, GLuint destination, GLintptr offset,
+                 GLsizeiptr size) {
+    GlStateCache::bindBuffer(GL_COPY_READ_BUFFER, source);
+    GlStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, destination);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, offset,
+                        size);
+  };
+  copy(vbo_, vbo, vertexOffset, vertexBufferSize());
+  copy(ebo_, ebo, indexOffset, indexBufferSize());
+}
+
+GLsizei Model::indexCount(size_t lod) const {
+  return static_cast<GLsizei>(
+      lods_[std::min(lod, lods_.size() - 1)].indexCount);
+}
+
+const void *Model::indexOffset(size_t lod) const {
+  return (void *)(lods_[std::min(lod, lods_.size() - 1)].firstIndex *
+                  indexTypeSize(indexType_));
+}
+
+void Model::draw(GLint object, size_t lod) const {
+  bind();
+  GlStateCache::uniform(objectIndexLocation, object);
+  glDrawElements(GL_TRIANGLES, indexCount(lod), indexType_, indexOffset(lod));
+}
+
+void Model::drawInstanced(GLint firstObject, size_t count, size_t lod) const {
+  if (count == 0)
+    return;
+  bind();
+  // Le nuanceur lit la matrice uObjectIndex + gl_InstanceID.
+  GlStateCache::uniform(objectIndexLocation, firstObject);
+  glDrawElementsInstanced(GL_TRIANGLES, indexCount(lod), indexType_,
+                          indexOffset(lod), static_cast<GLsizei>(count));
 }
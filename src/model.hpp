@@ -1,18 +1,138 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 #include <glbinding/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+#include "mesh.hpp"
+#include "ply_reader.hpp"
 
 using namespace gl;
 
+// Taille en octets d'un indice de type GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT ou
+// GL_UNSIGNED_INT.
+size_t indexTypeSize(GLenum indexType);
+
 class Model {
 public:
+  static constexpr size_t STREAMING_MIN_FILE_SIZE = size_t(512) << 20;
+
+  Model() = default;
+
+  // Les ressources OpenGL appartiennent à une seule instance; les modèles
+  // sont partagés par ModelRegistry plutôt que copiés.
+  Model(const Model &) = delete;
+  Model &operator=(const Model &) = delete;
+
+  // Lit le maillage du fichier (ou de son cache) et lui applique les
+  // traitements demandés, sans aucun appel OpenGL; peut donc être appelée
+  // depuis n'importe quel fil.
+  static MeshData read(const char *path, const MeshLoadOptions &options = {});
+
+  // Les fichiers d'au moins STREAMING_MIN_FILE_SIZE octets sans cache valide
+  // sont chargés par loadStreamed().
   void load(const char *path);
 
+  // Charge le fichier par morceaux d'au plus chunkBytes octets, transférés un
+  // à un vers la carte graphique: la mémoire utilisée ne dépend pas de la
+  // taille du fichier. Retourne false si le fichier n'est pas pris en charge
+  // par PlyStreamReader; lance std::runtime_error s'il est tronqué.
+  bool loadStreamed(const char *path,
+                    size_t chunkBytes = PlyStreamReader::DEFAULT_CHUNK_BYTES);
+
+  // Transfère vers la carte graphique un maillage obtenu par read().
+  void load(const MeshData &mesh);
+
+  // Format des sommets dans le VBO, Float par défaut. Doit être choisi avant
+  // le chargement.
+  void setVertexFormat(VertexFormat format);
+
+  VertexFormat vertexFormat() const { return vertexFormat_; }
+
+  // Traitements appliqués au maillage par load(path). Doivent être choisis
+  // avant le chargement.
+  void setLoadOptions(const MeshLoadOptions &options);
+
+  const MeshLoadOptions &loadOptions() const { return loadOptions_; }
+
+  // Emplacements des uniformes vec3 uPositionScale et uPositionOffset du
+  // programme qui dessine les modèles. draw() y envoie la transformation qui
+  // ramène les positions quantifiées dans l'espace du modèle (l'identité pour
+  // les modèles en float).
+  static void setDequantizationUniforms(GLint scaleLocation,
+                                        GLint offsetLocation);
+
+  // Emplacement de l'uniforme int uObjectIndex du programme qui dessine les
+  // modèles.
+  static void setObjectIndexUniform(GLint location);
+
   ~Model();
 
-  void draw() const;
+  // Volumes englobants des positions, dans l'espace du modèle.
+  const Bounds &bounds() const { return bounds_; }
+
+  // Niveau de détail à dessiner pour une instance dont les volumes
+  // englobants dans le monde sont worldBounds: le plus grossier dont
+  // l'erreur, projetée à l'écran au point le plus proche de l'instance, reste
+  // sous la tolérance.
+  size_t selectLod(const glm::mat4 &projView, const Bounds &worldBounds) const;
+
+  size_t lodCount() const { return lods_.size(); }
+
+  // Nom du VAO, pour regrouper les dessins qui le partagent.
+  GLuint vertexArray() const { return vao_; }
+
+  // Disposition des tampons du modèle, pour les copier dans des tampons
+  // partagés (voir IndirectRenderer).
+  const std::vector<MeshLod> &lods() const { return lods_; }
+  GLenum indexType() const { return indexType_; }
+  const Dequantization &dequantization() const { return dequantization_; }
+  GLsizeiptr vertexBufferSize() const;
+  GLsizeiptr indexBufferSize() const;
+
+  // Copie le VBO et le EBO dans vbo et ebo, à partir des octets vertexOffset
+  // et indexOffset.
+  void copyBuffers(GLuint vbo, GLintptr vertexOffset, GLuint ebo,
+                   GLintptr indexOffset) const;
+
+  // Décrit au VAO lié les attributs 0 (position) et 1 (couleur) de sommets
+  // au format format, lus dans le GL_ARRAY_BUFFER lié.
+  static void setVertexAttributes(VertexFormat format);
+
+  // Dessine le modèle avec la matrice numéro object du tampon d'objets (voir
+  // ObjectBuffer).
+  void draw(GLint object, size_t lod = 0) const;
+
+  // Dessine en un seul appel count instances, avec les matrices firstObject
+  // à firstObject + count - 1 du tampon d'objets.
+  void drawInstanced(GLint firstObject, size_t count, size_t lod = 0) const;
+
+  // Erreur projetée tolérée par selectLod(), en unités NDC (2 / hauteur de la
+  // fenêtre pour un pixel).
+  static void setLodTolerance(float ndcTolerance);
 
 private:
+  template <typename Reader> void upload(const Reader &reader);
+
+  void createBuffers();
+
+  // Envoie la déquantification et lie le VAO.
+  void bind() const;
+
+  // Nombre d'indices et position dans le EBO du niveau de détail.
+  GLsizei indexCount(size_t lod) const;
+  const void *indexOffset(size_t lod) const;
+
   GLuint vao_, vbo_, ebo_;
-  GLsizei count_;
+  size_t vertexCount_ = 0, indexCount_ = 0;
+  std::vector<MeshLod> lods_;
+  Bounds bounds_;
+  // Type des indices du EBO, le plus étroit selon le nombre de sommets.
+  GLenum indexType_ = GL_UNSIGNED_INT;
+  VertexFormat vertexFormat_ = VertexFormat::Float;
+  MeshLoadOptions loadOptions_;
+  Dequantization dequantization_;
 };
@@ -0,0 +1,52 @@
+#include "model_loader.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+ModelLoader::ModelLoader(size_t nThreads) : pool_(nThreads) {}
+
+void ModelLoader::request(Model &model, const char *path, MeshData *mesh) {
+  // Les très gros fichiers sont lus par morceaux pendant leur transfert, par
+  // finish(), plutôt que chargés en entier en mémoire.
+  std::error_code error;
+  if (std::filesystem::file_size(path, error) >=
+          Model::STREAMING_MIN_FILE_SIZE &&
+      !error) {
+    pending_.push_back({&model, path, {}, mesh});
+    return;
+  }
+
+  MeshLoadOptions options = model.loadOptions();
+  pending_.push_back(
+      {&model, path, pool_.submit([file = std::string(path), options]() {
+         return Model::read(file.c_str(), options);
+       }),
+       mesh});
+}
+
+void ModelLoader::finish() {
+  // Les modèles sont transférés dans l'ordre où leur lecture se termine, pour
+  // que les transferts se fassent pendant que les autres fichiers sont lus.
+  while (!pending_.empty()) {
+    auto ready = pending_.begin();
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+      if (!it->mesh.valid() || it->mesh.wait_for(std::chrono::seconds(0)) ==
+                                   std::future_status::ready) {
+        ready = it;
+        break;
+      }
+    }
+    Pending job = std::move(*ready);
+    pending_.erase(ready);
+    if (job.mesh.valid()) {
+      MeshData mesh = job.mesh.get();
+      job.model->load(mesh);
+      if (job.keptMesh != nullptr)
+        *job.keptMesh = std::move(mesh);
+    } else {
+      job.model->load(job.path.c_str());
+    }
+  }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "mesh.hpp"
+#include "model.hpp"
+#include "thread_pool.hpp"
+
+// Chargement des modèles en deux temps. La lecture et le décodage des
+// fichiers commencent dès request(), sur un ensemble de fils, ce qui permet
+// de les lancer avant même la création du contexte OpenGL. Seuls les
+// transferts vers la carte graphique sont faits par finish(), sur le fil du
+// contexte.
+class ModelLoader {
+public:
+  // Un fil par cœur si nThreads vaut 0.
+  explicit ModelLoader(size_t nThreads = 0);
+
+  // Le modèle doit rester valide jusqu'à l'appel de finish(). Si mesh n'est
+  // pas nul, le maillage lu y est gardé après son transfert, pour servir
+  // ailleurs sans relire le fichier; il reste vide si le fichier est lu par
+  // morceaux.
+  void request(Model &model, const char *path, MeshData *mesh = nullptr);
+
+  // Transfère chaque modèle demandé dès que sa lecture est terminée. Doit être
+  // appelée avec le contexte OpenGL actif. Relance l'exception de la première
+  // lecture ayant échoué.
+  void finish();
+
+private:
+  struct Pending {
+    Model *model;
+    std::string path;
+    std::future<MeshData> mesh; // Invalide si le modèle est lu par morceaux.
+    MeshData *keptMesh;
+  };
+
+  ThreadPool pool_;
+  std::vector<Pending> pending_;
+};
@@ -0,0 +1,55 @@
+#include "model_registry.hpp"
+
+#include <filesystem>
+
+std::shared_ptr<Model> ModelRegistry::acquire(const char *path,
+                                              ModelLoader &loader,
+                                              const MeshLoadOptions &options) {
+  std::string key = keyOf(path);
+  std::shared_ptr<Model> model = find(key);
+  if (model)
+    return model;
+
+  model = std::make_shared<Model>();
+  model->setLoadOptions(options);
+  loader.request(*model, path);
+  models_[key] = model;
+  return model;
+}
+
+std::shared_ptr<Model> ModelRegistry::acquire(const char *path,
+                                              const MeshLoadOptions &options) {
+  std::string key = keyOf(path);
+  std::shared_ptr<Model> model = find(key);
+  if (model)
+    return model;
+
+  model = std::make_shared<Model>();
+  model->setLoadOptions(options);
+  model->load(path);
+  models_[key] = model;
+  return model;
+}
+
+size_t ModelRegistry::size() const {
+  size_t count = 0;
+  for (const auto &[key, model] : models_)
+    count += !model.expired();
+  return count;
+}
+
+std::shared_ptr<Model> ModelRegistry::find(const std::string &key) {
+  auto it = models_.find(key);
+  if (it == models_.end())
+    return nullptr;
+  std::shared_ptr<Model> model = it->second.lock();
+  if (!model)
+    models_.erase(it);
+  return model;
+}
+
+// Deux écritures du même chemin (ex. "a/../b.ply" et "b.ply") désignent la
+// même entrée.
+std::string ModelRegistry::keyOf(const char *path) {
+  return std::filesystem::path(path).lexically_normal().generic_string();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "model.hpp"
+#include "model_loader.hpp"
+
+// Registre des modèles chargés, indexé par chemin de fichier. Les modèles sont
+// partagés: tant qu'une référence à un modèle existe, demander le même fichier
+// retourne la même instance au lieu de le relire et de le retransférer vers la
+// carte graphique. Le modèle est libéré avec sa dernière référence.
+class ModelRegistry {
+public:
+  // Retourne le modèle du fichier, en demandant sa lecture à loader s'il n'est
+  // pas déjà chargé (ou en cours de chargement). Le modèle est prêt après
+  // loader.finish(). Les options ne s'appliquent qu'au premier chargement.
+  std::shared_ptr<Model> acquire(const char *path, ModelLoader &loader,
+                                 const MeshLoadOptions &options = {});
+
+  // Comme ci-dessus, mais charge immédiatement le modèle; le contexte OpenGL
+  // doit être actif.
+  std::shared_ptr<Model> acquire(const char *path,
+                                 const MeshLoadOptions &options = {});
+
+  // Nombre de modèles distincts encore référencés.
+  size_t size() const;
+
+private:
+  std::shared_ptr<Model> find(const std::string &key);
+
+  static std::string keyOf(const char *path);
+
+  std::unordered_map<std::string, std::weak_ptr<Model>> models_;
+};
@@ -0,0 +1,35 @@
+#include "object_buffer.hpp"
+
+#include <algorithm>
+
+#include "gl_state.hpp"
+
+using namespace gl;
+
+ObjectBuffer::~ObjectBuffer() { glDeleteTextures(1, &texture_); }
+
+GLint ObjectBuffer::push(const glm::mat4 &matrix) {
+  matrices_.push_back(matrix);
+  return static_cast<GLint>(matrices_.size() - 1);
+}
+
+void ObjectBuffer::truncate(size_t count) {
+  matrices_.resize(std::min(count, matrices_.size()));
+}
+
+GLint ObjectBuffer::upload(StreamBuffer &stream) {
+  if (texture_ == 0)
+    glGenTextures(1, &texture_);
+
+  // Le tampon de texture couvre tout stream; les matrices sont alignées sur
+  // leur taille pour que leur position soit un numéro de matrice.
+  GlStateCache::bindTexture(TEXTURE_UNIT, GL_TEXTURE_BUFFER, texture_);
+  if (textureBuffer_ != stream.buffer()) {
+    textureBuffer_ = stream.buffer();
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, textureBuffer_);
+  }
+  GLintptr offset = stream.write(matrices_, sizeof(glm::mat4));
+  if (offset == StreamBuffer::FULL)
+    return -1;
+  return static_cast<GLint>(offset / sizeof(glm::mat4));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glbinding/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include "stream_buffer.hpp"
+
+// Matrices de modèle des objets dessinés dans une trame.
+//
+// Les matrices sont ajoutées sur le CPU puis écrites ensemble par upload()
+// dans la région de la trame d'un StreamBuffer, lu comme tampon de texture
+// (samplerBuffer uObjectMatrices, une colonne par texel): le nuanceur lit la
+// matrice uObjectBase + uObjectIndex + gl_InstanceID. Un dessin n'envoie
+// donc que le numéro de sa matrice. Le début de la liste peut être gardé
+// d'une trame à l'autre pour les objets immobiles.
+class ObjectBuffer {
+public:
+  // Unité de texture sur laquelle upload() lie le tampon.
+  static constexpr gl::GLuint TEXTURE_UNIT = 0;
+
+  ObjectBuffer() = default;
+
+  ObjectBuffer(const ObjectBuffer &) = delete;
+  ObjectBuffer &operator=(const ObjectBuffer &) = delete;
+
+  ~ObjectBuffer();
+
+  // Ajoute une matrice et retourne son numéro.
+  gl::GLint push(const glm::mat4 &matrix);
+
+  size_t size() const { return matrices_.size(); }
+
+  // Retire les matrices à partir du numéro count.
+  void truncate(size_t count);
+
+  // Écrit toutes les matrices dans stream, lie sur TEXTURE_UNIT le tampon de
+  // texture qui lit stream et retourne la position de la première matrice
+  // (uObjectBase), ou -1 si la région de la trame est pleine.
+  gl::GLint upload(StreamBuffer &stream);
+
+private:
+  std::vector<glm::mat4> matrices_;
+  gl::GLuint texture_ = 0, textureBuffer_ = 0;
+};
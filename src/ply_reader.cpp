@@ -0,0 +1,683 @@
+#include "ply_reader.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+using namespace gl;
+
+namespace {
+
+bool isLittleEndianHost() {
+  const uint16_t one = 1;
+  unsigned char firstByte;
+  std::memcpy(&firstByte, &one, 1);
+  return firstByte == 1;
+}
+
+template <typename T> T load(const char *p) {
+  T value;
+  std::memcpy(&value, p, sizeof(T));
+  return value;
+}
+
+bool parseType(std::string_view name, PlyType &type) {
+  if (name == "char" || name == "int8")
+    type = PlyType::Int8;
+  else if (name == "uchar" || name == "uint8")
+    type = PlyType::UInt8;
+  else if (name == "short" || name == "int16")
+    type = PlyType::Int16;
+  else if (name == "ushort" || name == "uint16")
+    type = PlyType::UInt16;
+  else if (name == "int" || name == "int32")
+    type = PlyType::Int32;
+  else if (name == "uint" || name == "uint32")
+    type = PlyType::UInt32;
+  else if (name == "float" || name == "float32")
+    type = PlyType::Float;
+  else if (name == "double" || name == "float64")
+    type = PlyType::Double;
+  else
+    return false;
+  return true;
+}
+
+bool isIntegerType(PlyType type) {
+  return type != PlyType::Float && type != PlyType::Double;
+}
+
+// Découpe une ligne d'en-tête en mots séparés par des espaces.
+std::vector<std::string_view> splitTokens(std::string_view line) {
+  std::vector<std::string_view> tokens;
+  size_t pos = 0;
+  while (pos < line.size()) {
+    size_t start = line.find_first_not_of(" \t\r", pos);
+    if (start == std::string_view::npos)
+      break;
+    size_t stop = line.find_first_of(" \t\r", start);
+    if (stop == std::string_view::npos)
+      stop = line.size();
+    tokens.push_back(line.substr(start, stop - start));
+    pos = stop;
+  }
+  return tokens;
+}
+
+// Le compte d'une liste est toujours lu comme un entier non signé, comme le
+// fait happly.
+size_t readCount(const char *p, PlyType type) {
+  switch (plyTypeSize(type)) {
+  case 1:
+    return load<uint8_t>(p);
+  case 2:
+    return load<uint16_t>(p);
+  default:
+    return load<uint32_t>(p);
+  }
+}
+
+// Avance d'une propriété, sans vérification des bornes.
+const char *skipProperty(const char *p, const PlyProperty &property) {
+  if (!property.isList)
+    return p + plyTypeSize(property.type);
+  size_t count = readCount(p, property.countType);
+  return p + plyTypeSize(property.countType) +
+         count * plyTypeSize(property.type);
+}
+
+// Avance d'un enregistrement dont on sait qu'il est complet.
+const char *nextRecord(const char *p,
+                       const std::vector<PlyProperty> &properties) {
+  for (const PlyProperty &property : properties)
+    p = skipProperty(p, property);
+  return p;
+}
+
+// Avance d'un enregistrement complet. Retourne nullptr si l'enregistrement
+// dépasse la fin du fichier.
+const char *skipRecord(const char *p, const char *end,
+                       const std::vector<PlyProperty> &properties) {
+  for (const PlyProperty &property : properties) {
+    if (property.isList) {
+      size_t countSize = plyTypeSize(property.countType);
+      if (static_cast<size_t>(end - p) < countSize)
+        return nullptr;
+      size_t count = readCount(p, property.countType);
+      p += countSize;
+      size_t listSize = count * plyTypeSize(property.type);
+      if (static_cast<size_t>(end - p) < listSize)
+        return nullptr;
+      p += listSize;
+    } else {
+      size_t size = plyTypeSize(property.type);
+      if (static_cast<size_t>(end - p) < size)
+        return nullptr;
+      p += size;
+    }
+  }
+  return p;
+}
+
+// Taille fixe d'un enregistrement, ou 0 si l'élément contient une liste.
+size_t fixedStride(const PlyElement &element) {
+  size_t stride = 0;
+  for (const PlyProperty &property : element.properties) {
+    if (property.isList)
+      return 0;
+    stride += plyTypeSize(property.type);
+  }
+  return stride;
+}
+
+// Conversion des indices vers GLuint, de la même façon que
+// happly::PLYData::getFaceIndices<unsigned int>().
+GLuint *copyIndices(const char *p, PlyType type, size_t count, GLuint *dst) {
+  switch (type) {
+  case PlyType::Int32:
+  case PlyType::UInt32:
+    std::memcpy(dst, p, count * sizeof(GLuint));
+    break;
+  case PlyType::Int16:
+    for (size_t i = 0; i < count; ++i)
+      dst[i] = static_cast<GLuint>(load<int16_t>(p + 2 * i));
+    break;
+  case PlyType::UInt16:
+    for (size_t i = 0; i < count; ++i)
+      dst[i] = load<uint16_t>(p + 2 * i);
+    break;
+  case PlyType::Int8:
+    for (size_t i = 0; i < count; ++i)
+      dst[i] = static_cast<GLuint>(static_cast<int8_t>(p[i]));
+    break;
+  default:
+    for (size_t i = 0; i < count; ++i)
+      dst[i] = static_cast<unsigned char>(p[i]);
+    break;
+  }
+  return dst + count;
+}
+
+// Retourne false si l'élément n'a pas exactement les types attendus (float
+// x/y/z, uchar red/green/blue) ou contient une liste.
+bool findVertexLayout(const PlyElement &element, VertexLayout &layout) {
+  const char *const POSITION_NAMES[] = {"x", "y", "z"};
+  const char *const COLOR_NAMES[] = {"red", "green", "blue"};
+  bool hasPosition[3] = {}, hasColor[3] = {};
+
+  layout.stride = fixedStride(element);
+  if (layout.stride == 0)
+    return false;
+
+  size_t offset = 0;
+  for (const PlyProperty &property : element.properties) {
+    for (int i = 0; i < 3; ++i) {
+      if (property.name == POSITION_NAMES[i]) {
+        if (property.type != PlyType::Float)
+          return false;
+        layout.positionOffsets[i] = offset;
+        hasPosition[i] = true;
+      } else if (property.name == COLOR_NAMES[i]) {
+        if (property.type != PlyType::UInt8)
+          return false;
+        layout.colorOffsets[i] = offset;
+        hasColor[i] = true;
+      }
+    }
+    offset += plyTypeSize(property.type);
+  }
+  for (int i = 0; i < 3; ++i)
+    if (!hasPosition[i] || !hasColor[i])
+      return false;
+  return true;
+}
+
+// Schémas connus, utilisés par tous nos modèles. Leur disposition est une
+// constante de compilation: le décodage se réduit à une boucle à pas fixe,
+// sans position de propriété lue en mémoire ni conversion selon le type.
+
+// Sommets "float x, y, z; uchar red, green, blue[, alpha]", dans cet ordre.
+bool isStandardVertexLayout(const VertexLayout &layout) {
+  return layout.positionOffsets[0] == 0 && layout.positionOffsets[1] == 4 &&
+         layout.positionOffsets[2] == 8 && layout.colorOffsets[0] == 12 &&
+         layout.colorOffsets[1] == 13 && layout.colorOffsets[2] == 14;
+}
+
+template <size_t STRIDE>
+void decodeStandardVertices(const char *records, size_t count,
+                            Vertex3D *dst) {
+  for (size_t i = 0; i < count; ++i) {
+    const char *record = records + i * STRIDE;
+    const unsigned char *color =
+        reinterpret_cast<const unsigned char *>(record + 12);
+    dst[i] = {{load<float>(record), load<float>(record + 4),
+               load<float>(record + 8)},
+              {color[0] / 255.0f, color[1] / 255.0f, color[2] / 255.0f}};
+  }
+}
+
+// Faces "list uchar uint vertex_indices" seules.
+bool isStandardFaceSchema(const std::vector<PlyProperty> &properties) {
+  return properties.size() == 1 &&
+         properties[0].countType == PlyType::UInt8 &&
+         (properties[0].type == PlyType::UInt32 ||
+          properties[0].type == PlyType::Int32);
+}
+
+// Les triangles, enregistrements de 13 octets, sont copiés par un memcpy de
+// taille constante.
+GLuint *decodeStandardFaces(const char *p, size_t count, GLuint *dst) {
+  for (size_t f = 0; f < count; ++f) {
+    size_t n = static_cast<unsigned char>(*p++);
+    if (n == 3)
+      std::memcpy(dst, p, 3 * sizeof(GLuint));
+    else
+      std::memcpy(dst, p, n * sizeof(GLuint));
+    dst += n;
+    p += n * sizeof(GLuint);
+  }
+  return dst;
+}
+
+// Valide les bornes de count faces du schéma standard et compte leurs
+// indices. Retourne la fin des faces, ou nullptr si elles dépassent end.
+const char *countStandardFaces(const char *p, const char *end, size_t count,
+                               size_t &indexCount) {
+  for (size_t f = 0; f < count; ++f) {
+    if (p == end)
+      return nullptr;
+    size_t n = static_cast<unsigned char>(*p++);
+    if (static_cast<size_t>(end - p) < n * sizeof(GLuint))
+      return nullptr;
+    indexCount += n;
+    p += n * sizeof(GLuint);
+  }
+  return p;
+}
+
+void decodeVertices(const char *records, size_t count,
+                    const VertexLayout &layout, Vertex3D *dst) {
+  if (isStandardVertexLayout(layout)) {
+    switch (layout.stride) {
+    case 15:
+      decodeStandardVertices<15>(records, count, dst);
+      return;
+    case 16:
+      decodeStandardVertices<16>(records, count, dst);
+      return;
+    }
+  }
+
+  // Disposition quelconque.
+  const size_t x = layout.positionOffsets[0], y = layout.positionOffsets[1],
+               z = layout.positionOffsets[2];
+  const size_t r = layout.colorOffsets[0], g = layout.colorOffsets[1],
+               b = layout.colorOffsets[2];
+  for (size_t i = 0; i < count; ++i) {
+    const char *record = records + i * layout.stride;
+    const unsigned char *bytes =
+        reinterpret_cast<const unsigned char *>(record);
+    dst[i] = {{load<float>(record + x), load<float>(record + y),
+               load<float>(record + z)},
+              {bytes[r] / 255.0f, bytes[g] / 255.0f, bytes[b] / 255.0f}};
+  }
+}
+
+// Cherche la liste des indices d'une face. Retourne false si elle est absente
+// ou n'est pas une liste d'entiers.
+bool findIndicesProperty(const PlyElement &element, size_t &index) {
+  for (size_t i = 0; i < element.properties.size(); ++i) {
+    const PlyProperty &property = element.properties[i];
+    if (property.isList && (property.name == "vertex_indices" ||
+                            property.name == "vertex_index")) {
+      index = i;
+      return isIntegerType(property.type);
+    }
+  }
+  return false;
+}
+
+// Nombre d'indices de la face qui commence à record.
+size_t faceIndexCount(const char *record,
+                      const std::vector<PlyProperty> &properties,
+                      size_t indicesProperty) {
+  for (size_t i = 0; i < indicesProperty; ++i)
+    record = skipProperty(record, properties[i]);
+  return readCount(record, properties[indicesProperty].countType);
+}
+
+// Décode les indices de count faces consécutives. Retourne la fin de dst.
+GLuint *decodeFaces(const char *records, size_t count,
+                    const std::vector<PlyProperty> &properties,
+                    size_t indicesProperty, GLuint *dst) {
+  if (isStandardFaceSchema(properties))
+    return decodeStandardFaces(records, count, dst);
+
+  const char *p = records;
+  for (size_t f = 0; f < count; ++f) {
+    for (size_t i = 0; i < properties.size(); ++i) {
+      const PlyProperty &property = properties[i];
+      if (i == indicesProperty) {
+        size_t n = readCount(p, property.countType);
+        dst = copyIndices(p + plyTypeSize(property.countType), property.type,
+                          n, dst);
+      }
+      p = skipProperty(p, property);
+    }
+  }
+  return dst;
+}
+
+} // namespace
+
+size_t plyTypeSize(PlyType type) {
+  switch (type) {
+  case PlyType::Int8:
+  case PlyType::UInt8:
+    return 1;
+  case PlyType::Int16:
+  case PlyType::UInt16:
+    return 2;
+  case PlyType::Int32:
+  case PlyType::UInt32:
+  case PlyType::Float:
+    return 4;
+  case PlyType::Double:
+    return 8;
+  }
+  return 0;
+}
+
+bool parsePlyHeader(const char *data, size_t size, PlyHeader &header) {
+  header = {};
+  std::string_view text(data, size);
+  size_t lineStart = 0;
+  int lineNumber = 0;
+
+  while (lineStart < text.size()) {
+    size_t lineEnd = text.find('\n', lineStart);
+    if (lineEnd == std::string_view::npos)
+      return false;
+    std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+    lineStart = lineEnd + 1;
+    std::vector<std::string_view> tokens = splitTokens(line);
+
+    // La première ligne est le nombre magique du format.
+    if (lineNumber++ == 0) {
+      if (tokens.size() != 1 || tokens[0] != "ply")
+        return false;
+      continue;
+    }
+    if (tokens.empty())
+      continue;
+
+    if (tokens[0] == "format") {
+      if (tokens.size() != 3 || tokens[2] != "1.0")
+        return false;
+      if (tokens[1] == "ascii")
+        header.format = PlyFormat::Ascii;
+      else if (tokens[1] == "binary_little_endian")
+        header.format = PlyFormat::BinaryLittleEndian;
+      else if (tokens[1] == "binary_big_endian")
+        header.format = PlyFormat::BinaryBigEndian;
+      else
+        return false;
+    } else if (tokens[0] == "comment" || tokens[0] == "obj_info") {
+      continue;
+    } else if (tokens[0] == "element") {
+      if (tokens.size() != 3)
+        return false;
+      PlyElement element;
+      element.name = tokens[1];
+      const char *last = tokens[2].data() + tokens[2].size();
+      if (std::from_chars(tokens[2].data(), last, element.count).ptr != last)
+        return false;
+      header.elements.push_back(std::move(element));
+    } else if (tokens[0] == "property") {
+      if (header.elements.empty())
+        return false;
+      PlyProperty property = {};
+      if (tokens.size() == 5 && tokens[1] == "list") {
+        property.isList = true;
+        if (!parseType(tokens[2], property.countType) ||
+            !isIntegerType(property.countType) ||
+            !parseType(tokens[3], property.type))
+          return false;
+        property.name = tokens[4];
+      } else if (tokens.size() == 3) {
+        if (!parseType(tokens[1], property.type))
+          return false;
+        property.name = tokens[2];
+      } else {
+        return false;
+      }
+      header.elements.back().properties.push_back(std::move(property));
+    } else if (tokens[0] == "end_header") {
+      header.bodyOffset = lineStart;
+      return true;
+    } else {
+      return false;
+    }
+  }
+  return false;
+}
+
+bool PlyMeshReader::open(const char *path) {
+  vertexData_ = faceData_ = nullptr;
+  if (!isLittleEndianHost() || !file_.open(path))
+    return false;
+
+  PlyHeader header;
+  if (!parsePlyHeader(file_.data(), file_.size(), header) ||
+      header.format != PlyFormat::BinaryLittleEndian)
+    return false;
+
+  // Les éléments se suivent dans l'ordre de l'en-tête; on repère le début de
+  // chacun en sautant ceux qui précèdent.
+  const char *p = file_.data() + header.bodyOffset;
+  const char *end = file_.data() + file_.size();
+  for (const PlyElement &element : header.elements) {
+    size_t stride = fixedStride(element);
+    if (element.name == "vertex") {
+      if (!locateVertices(element, p))
+        return false;
+    } else if (element.name == "face") {
+      if (!locateFaces(element, p, end))
+        return false;
+    }
+
+    if (stride > 0 || element.properties.empty()) {
+      // Comparé par division: le produit peut déborder si l'en-tête annonce
+      // un nombre démesuré d'enregistrements.
+      if (stride > 0 && element.count > static_cast<size_t>(end - p) / stride)
+        return false;
+      p += stride * element.count;
+    } else {
+      for (size_t i = 0; i < element.count && p != nullptr; ++i)
+        p = skipRecord(p, end, element.properties);
+      if (p == nullptr)
+        return false;
+    }
+  }
+  return vertexData_ != nullptr && faceData_ != nullptr;
+}
+
+bool PlyMeshReader::locateVertices(const PlyElement &element,
+                                   const char *data) {
+  if (!findVertexLayout(element, vertexLayout_))
+    return false;
+  vertexData_ = data;
+  vertexCount_ = element.count;
+  return true;
+}
+
+bool PlyMeshReader::locateFaces(const PlyElement &element, const char *data,
+                                const char *end) {
+  faceProperties_ = element.properties;
+  if (!findIndicesProperty(element, indicesProperty_))
+    return false;
+
+  // Premier passage pour valider les bornes et compter les indices, ce qui
+  // permet à l'appelant d'allouer la destination d'un seul coup.
+  indexCount_ = 0;
+  if (isStandardFaceSchema(faceProperties_)) {
+    if (countStandardFaces(data, end, element.count, indexCount_) == nullptr)
+      return false;
+  } else {
+    const char *p = data;
+    for (size_t f = 0; f < element.count; ++f) {
+      const char *record = p;
+      p = skipRecord(p, end, faceProperties_);
+      if (p == nullptr)
+        return false;
+      indexCount_ +=
+          faceIndexCount(record, faceProperties_, indicesProperty_);
+    }
+  }
+
+  faceData_ = data;
+  faceCount_ = element.count;
+  return true;
+}
+
+void PlyMeshReader::readVertices(Vertex3D *dst) const {
+  decodeVertices(vertexData_, vertexCount_, vertexLayout_, dst);
+}
+
+void PlyMeshReader::readIndices(GLuint *dst) const {
+  decodeFaces(faceData_, faceCount_, faceProperties_, indicesProperty_, dst);
+}
+
+PlyStreamReader::PlyStreamReader(size_t chunkBytes)
+    : buffer_(std::max<size_t>(chunkBytes, 4096)) {}
+
+bool PlyStreamReader::open(const char *path) {
+  if (!isLittleEndianHost())
+    return false;
+  file_.close();
+  file_.clear();
+  file_.open(path, std::ios::binary);
+  if (!file_)
+    return false;
+
+  // L'en-tête est lu par blocs jusqu'à "end_header".
+  std::string text;
+  PlyHeader header;
+  char block[4096];
+  for (;;) {
+    file_.read(block, sizeof(block));
+    text.append(block, static_cast<size_t>(file_.gcount()));
+    if (parsePlyHeader(text.data(), text.size(), header))
+      break;
+    if (!file_ || text.find("end_header") != std::string::npos)
+      return false;
+  }
+  if (header.format != PlyFormat::BinaryLittleEndian)
+    return false;
+  header_ = std::move(header);
+
+  const PlyElement *vertices = nullptr, *faces = nullptr;
+  for (const PlyElement &element : header_.elements) {
+    if (element.name == "vertex")
+      vertices = &element;
+    else if (element.name == "face")
+      faces = &element;
+  }
+  if (vertices == nullptr || faces == nullptr ||
+      !findVertexLayout(*vertices, vertexLayout_) ||
+      !findIndicesProperty(*faces, indicesProperty_))
+    return false;
+  vertexCount_ = vertices->count;
+  faceProperties_ = faces->properties;
+
+  indexCount_ = 0;
+  return visit(
+      [this](const PlyElement &, size_t, const char *records, size_t count) {
+        const char *p = records;
+        for (size_t f = 0; f < count; ++f) {
+          indexCount_ += faceIndexCount(p, faceProperties_, indicesProperty_);
+          p = nextRecord(p, faceProperties_);
+        }
+      },
+      "face");
+}
+
+bool PlyStreamReader::visit(const ChunkVisitor &visitor) {
+  return visit(visitor, nullptr);
+}
+
+bool PlyStreamReader::readVertices(const DataVisitor<Vertex3D> &visitor) {
+  std::vector<Vertex3D> decoded;
+  return visit(
+      [&](const PlyElement &, size_t first, const char *records,
+          size_t count) {
+        decoded.resize(count);
+        decodeVertices(records, count, vertexLayout_, decoded.data());
+        visitor(first, decoded.data(), count);
+      },
+      "vertex");
+}
+
+bool PlyStreamReader::readIndices(const DataVisitor<GLuint> &visitor) {
+  std::vector<GLuint> decoded;
+  size_t written = 0;
+  return visit(
+      [&](const PlyElement &, size_t, const char *records, size_t count) {
+        size_t n = 0;
+        const char *p = records;
+        for (size_t f = 0; f < count; ++f) {
+          n += faceIndexCount(p, faceProperties_, indicesProperty_);
+          p = nextRecord(p, faceProperties_);
+        }
+        decoded.resize(n);
+        decodeFaces(records, count, faceProperties_, indicesProperty_,
+                    decoded.data());
+        visitor(written, decoded.data(), n);
+        written += n;
+      },
+      "face");
+}
+
+bool PlyStreamReader::visit(const ChunkVisitor &visitor, const char *only) {
+  file_.clear();
+  file_.seekg(static_cast<std::streamoff>(header_.bodyOffset));
+  begin_ = end_ = 0;
+
+  for (const PlyElement &element : header_.elements) {
+    bool isVisited = only == nullptr || element.name == only;
+    size_t stride = fixedStride(element);
+    if (!isVisited && (stride > 0 || element.properties.empty())) {
+      if (stride > 0 && element.count > SIZE_MAX / stride)
+        return false;
+      if (!skipBytes(stride * element.count))
+        return false;
+      continue;
+    }
+
+    size_t first = 0;
+    while (first < element.count) {
+      // Enregistrements complets déjà dans le tampon.
+      const char *data = buffer_.data();
+      const char *p = data + begin_, *end = data + end_;
+      size_t count = 0;
+      if (stride > 0) {
+        count = std::min(element.count - first,
+                         static_cast<size_t>(end - p) / stride);
+        p += count * stride;
+      } else {
+        for (const char *next; count < element.count - first &&
+                               (next = skipRecord(p, end, element.properties));
+             ++count)
+          p = next;
+      }
+
+      if (count == 0) {
+        if (!refill())
+          return false;
+        continue;
+      }
+      if (isVisited)
+        visitor(element, first, data + begin_, count);
+      first += count;
+      begin_ = p - data;
+    }
+    if (only != nullptr && isVisited)
+      return true;
+  }
+  return only == nullptr;
+}
+
+bool PlyStreamReader::skipBytes(size_t size) {
+  size_t buffered = end_ - begin_;
+  if (size <= buffered) {
+    begin_ += size;
+    return true;
+  }
+  begin_ = end_ = 0;
+  if (size - buffered >
+      static_cast<size_t>(std::numeric_limits<std::streamoff>::max()))
+    return false;
+  file_.seekg(static_cast<std::streamoff>(size - buffered), std::ios::cur);
+  return static_cast<bool>(file_);
+}
+
+// Déplace les octets non consommés au début du tampon et complète celui-ci.
+// Le tampon n'est agrandi que s'il est plein sans contenir un enregistrement
+// complet.
+bool PlyStreamReader::refill() {
+  size_t remaining = end_ - begin_;
+  if (begin_ == 0 && end_ == buffer_.size())
+    buffer_.resize(buffer_.size() * 2);
+  std::memmove(buffer_.data(), buffer_.data() + begin_, remaining);
+  begin_ = 0;
+  end_ = remaining;
+
+  file_.read(buffer_.data() + end_,
+             static_cast<std::streamsize>(buffer_.size() - end_));
+  size_t read = static_cast<size_t>(file_.gcount());
+  end_ += read;
+  return read > 0;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <glbinding/gl/gl.h>
+
+#include "mapped_file.hpp"
+#include "mesh.hpp"
+
+enum class PlyFormat { Ascii, BinaryLittleEndian, BinaryBigEndian };
+
+enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float, Double };
+
+size_t plyTypeSize(PlyType type);
+
+struct PlyProperty {
+  std::string name;
+  PlyType type;
+  bool isList;
+  PlyType countType; // Seulement pour les listes.
+};
+
+struct PlyElement {
+  std::string name;
+  size_t count;
+  std::vector<PlyProperty> properties;
+};
+
+struct PlyHeader {
+  PlyFormat format;
+  std::vector<PlyElement> elements;
+  size_t bodyOffset; // Position du premier octet après "end_header".
+};
+
+// Analyse l'en-tête d'un fichier .ply en mémoire. Retourne false si
+// l'en-tête est invalide ou incomplet.
+bool parsePlyHeader(const char *data, size_t size, PlyHeader &header);
+
+// Position des propriétés utilisées par Model dans un enregistrement de
+// sommet à taille fixe.
+struct VertexLayout {
+  size_t stride;
+  size_t positionOffsets[3];
+  size_t colorOffsets[3];
+};
+
+// Lecteur rapide des maillages .ply binaires little-endian.
+//
+// Le fichier est projeté en mémoire et chaque élément est décodé par une
+// seule boucle serrée, sans passer par un flux ni par un appel virtuel par
+// valeur comme happly. open() refuse les fichiers ASCII, big-endian ou dont
+// les propriétés n'ont pas les types attendus par Model (float x/y/z, uchar
+// red/green/blue); ceux-ci doivent passer par happly.
+class PlyMeshReader {
+public:
+  bool open(const char *path);
+
+  size_t vertexCount() const { return vertexCount_; }
+
+  size_t indexCount() const { return indexCount_; }
+
+  // Décode les sommets dans dst, qui doit contenir vertexCount() éléments.
+  void readVertices(Vertex3D *dst) const;
+
+  // Décode les indices des faces dans dst, qui doit contenir indexCount()
+  // éléments.
+  void readIndices(gl::GLuint *dst) const;
+
+private:
+  bool locateVertices(const PlyElement &element, const char *data);
+  bool locateFaces(const PlyElement &element, const char *data,
+                   const char *end);
+
+  MappedFile file_;
+
+  const char *vertexData_ = nullptr;
+  size_t vertexCount_ = 0;
+  VertexLayout vertexLayout_ = {};
+
+  const char *faceData_ = nullptr;
+  size_t faceCount_ = 0;
+  size_t indexCount_ = 0;
+  std::vector<PlyProperty> faceProperties_;
+  size_t indicesProperty_ = 0;
+};
+
+// Lecteur des maillages .ply binaires little-endian par morceaux de taille
+// bornée, pour les fichiers trop gros pour être chargés en entier.
+//
+// Le fichier est lu par un tampon d'au plus chunkBytes octets (agrandi
+// seulement si un enregistrement seul ne tient pas), et chaque morceau
+// d'enregistrements complets est passé à un visiteur. La mémoire utilisée ne
+// dépend donc pas de la taille du fichier. Accepte les mêmes fichiers que
+// PlyMeshReader.
+class PlyStreamReader {
+public:
+  static constexpr size_t DEFAULT_CHUNK_BYTES = 16 << 20;
+
+  // Appelé pour chaque morceau de count enregistrements bruts consécutifs de
+  // element, le premier étant l'enregistrement numéro first.
+  using ChunkVisitor = std::function<void(const PlyElement &element,
+                                          size_t first, const char *records,
+                                          size_t count)>;
+
+  template <typename T>
+  using DataVisitor =
+      std::function<void(size_t first, const T *data, size_t count)>;
+
+  explicit PlyStreamReader(size_t chunkBytes = DEFAULT_CHUNK_BYTES);
+
+  // Lit l'en-tête et compte les indices des faces (un passage sur les faces,
+  // sans lire les sommets).
+  bool open(const char *path);
+
+  const PlyHeader &header() const { return header_; }
+
+  size_t vertexCount() const { return vertexCount_; }
+
+  size_t indexCount() const { return indexCount_; }
+
+  // Visite tous les éléments du fichier, dans l'ordre. Retourne false si le
+  // fichier est tronqué.
+  bool visit(const ChunkVisitor &visitor);
+
+  // Décode les sommets par morceaux, dans la disposition de Vertex3D.
+  bool readVertices(const DataVisitor<Vertex3D> &visitor);
+
+  // Décode les indices des faces par morceaux; first est la position du
+  // premier indice du morceau.
+  bool readIndices(const DataVisitor<gl::GLuint> &visitor);
+
+private:
+  // Visite seulement l'élément nommé only (tous si nullptr); les éléments à
+  // taille fixe qui précèdent sont sautés sans être lus.
+  bool visit(const ChunkVisitor &visitor, const char *only);
+
+  bool skipBytes(size_t size);
+
+  bool refill();
+
+  std::ifstream file_;
+  PlyHeader header_;
+  std::vector<char> buffer_;
+  size_t begin_ = 0, end_ = 0;
+
+  size_t vertexCount_ = 0;
+  VertexLayout vertexLayout_ = {};
+  size_t indexCount_ = 0;
+  std::vector<PlyProperty> faceProperties_;
+  size_t indicesProperty_ = 0;
+};
@@ -0,0 +1,123 @@
+#include "render_queue.hpp"
+
+#include "gl_state.hpp"
+#include "indirect_renderer.hpp"
+
+#include <array>
+#include <cstring>
+
+using namespace gl;
+
+namespace {
+
+GLint colorModLocation = -1;
+
+// Clé de tri, des bits de poids fort aux bits de poids faible: programme (8
+// bits), état (8 bits), VAO (16 bits) et profondeur (32 bits). Seuls les
+// bits de poids faible des noms OpenGL sont gardés: deux noms qui partagent
+// ces bits ne sont plus regroupés, mais l'ordre reste valide puisque
+// execute() lit l'état dans le dessin et non dans la clé.
+uint64_t sortKey(const DrawPacket &packet, GLuint vao, float depth) {
+  // Les float positifs ou nuls sont ordonnés comme leur représentation.
+  uint32_t depthBits;
+  depth = depth > 0.0f ? depth : 0.0f;
+  std::memcpy(&depthBits, &depth, sizeof(depthBits));
+
+  uint64_t state = packet.isTwoSided ? 1 : 0;
+  return (uint64_t(packet.program & 0xff) << 56) | (state << 48) |
+         (uint64_t(vao & 0xffff) << 32) | depthBits;
+}
+
+// Tri par base 256, octet de poids faible en premier, stable. Les octets
+// identiques dans toutes les clés (souvent le programme et l'état) sont
+// sautés. Le résultat est dans entries.
+template <typename Entry>
+void radixSort(std::vector<Entry> &entries, std::vector<Entry> &scratch) {
+  constexpr size_t N_BYTES = sizeof(uint64_t);
+  std::array<std::array<uint32_t, 256>, N_BYTES> counts = {};
+  for (const Entry &entry : entries)
+    for (size_t byte = 0; byte < N_BYTES; ++byte)
+      ++counts[byte][(entry.key >> (8 * byte)) & 0xff];
+
+  scratch.resize(entries.size());
+  for (size_t byte = 0; byte < N_BYTES; ++byte) {
+    std::array<uint32_t, 256> &offsets = counts[byte];
+    uint32_t first = static_cast<uint32_t>((entries[0].key >> (8 * byte)) &
+                                           0xff);
+    if (offsets[first] == entries.size())
+      continue;
+
+    uint32_t sum = 0;
+    for (uint32_t &offset : offsets) {
+      uint32_t count = offset;
+      offset = sum;
+      sum += count;
+    }
+    for (const Entry &entry : entries)
+      scratch[offsets[(entry.key >> (8 * byte)) & 0xff]++] = entry;
+    entries.swap(scratch);
+  }
+}
+
+} // namespace
+
+void RenderQueue::setColorModUniform(GLint location) {
+  colorModLocation = location;
+}
+
+void RenderQueue::begin(const glm::mat4 &view, IndirectRenderer *indirect) {
+  indirect_ = indirect;
+  // Profondeur = -z dans l'espace de la caméra: opposé de la 3e ligne de la
+  // matrice de vue.
+  depthAxis_ = -glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+  packets_.clear();
+  entries_.clear();
+}
+
+float RenderQueue::depth(const Bounds &worldBounds) const {
+  const BoundingSphere &sphere = worldBounds.sphere;
+  return glm::dot(depthAxis_, glm::vec4(sphere.center, 1.0f)) - sphere.radius;
+}
+
+void RenderQueue::submit(const DrawPacket &packet, float depth) {
+  if (packet.count == 0)
+    return;
+  // Les dessins indirects sont regroupés par tampons partagés.
+  GLuint vao = indirect_ != nullptr ? indirect_->vertexArray(*packet.model) : 0;
+  if (vao == 0)
+    vao = packet.model->vertexArray();
+  entries_.push_back(
+      {sortKey(packet, vao, depth), static_cast<uint32_t>(packets_.size())});
+  packets_.push_back(packet);
+}
+
+void RenderQueue::execute() {
+  if (entries_.empty())
+    return;
+  radixSort(entries_, scratch_);
+
+  if (indirect_ != nullptr) {
+    sorted_.clear();
+    for (const SortEntry &entry : entries_)
+      sorted_.push_back(&packets_[entry.packet]);
+    indirect_->draw(sorted_, [this](const DrawPacket &packet) {
+      executeDirect(packet);
+    });
+    return;
+  }
+
+  for (const SortEntry &entry : entries_)
+    executeDirect(packets_[entry.packet]);
+}
+
+void RenderQueue::executeDirect(const DrawPacket &packet) const {
+  // GlStateCache évite les changements d'état entre dessins voisins qui
+  // partagent le même.
+  GlStateCache::useProgram(packet.program);
+  GlStateCache::setEnabled(GL_CULL_FACE, !packet.isTwoSided);
+  GlStateCache::uniform(colorModLocation, packet.colorMod);
+  if (packet.count == 1)
+    packet.model->draw(packet.firstObject, packet.lod);
+  else
+    packet.model->drawInstanced(packet.firstObject, packet.count, packet.lod);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glbinding/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+#include "model.hpp"
+
+class IndirectRenderer;
+
+// Dessin soumis à une RenderQueue: count instances d'un modèle avec les
+// matrices firstObject à firstObject + count - 1 du tampon d'objets, et
+// l'état OpenGL qu'il demande.
+struct DrawPacket {
+  gl::GLuint program = 0;
+  const Model *model = nullptr;
+  gl::GLint firstObject = 0;
+  size_t count = 1;
+  size_t lod = 0;
+  glm::vec3 colorMod = glm::vec3(1.0f);
+  // Dessiné sans face culling.
+  bool isTwoSided = false;
+};
+
+// File des dessins d'une trame.
+//
+// Les dessins sont soumis dans n'importe quel ordre puis exécutés par
+// execute() triés selon une clé de 64 bits: programme, état, VAO, puis
+// profondeur croissante. Les changements d'état sont ainsi regroupés et,
+// pour un même état, les objets proches sont dessinés en premier pour que le
+// test de profondeur précoce élimine les fragments cachés.
+class RenderQueue {
+public:
+  // Emplacement de l'uniforme vec3 uColorMod du programme qui dessine les
+  // modèles.
+  static void setColorModUniform(gl::GLint location);
+
+  // Vide la file. Les profondeurs sont mesurées dans la direction de la
+  // caméra de matrice de vue view. Si indirect n'est pas nul, les dessins de
+  // la trame sont exécutés par lui (voir IndirectRenderer) plutôt qu'un à un.
+  void begin(const glm::mat4 &view, IndirectRenderer *indirect = nullptr);
+
+  // Profondeur du point le plus proche de la sphère englobante dans le monde,
+  // nulle si la caméra est dans la sphère.
+  float depth(const Bounds &worldBounds) const;
+
+  void submit(const DrawPacket &packet, float depth);
+
+  size_t size() const { return packets_.size(); }
+
+  // Trie les dessins soumis et les exécute.
+  void execute();
+
+private:
+  struct SortEntry {
+    uint64_t key;
+    uint32_t packet;
+  };
+
+  void executeDirect(const DrawPacket &packet) const;
+
+  glm::vec4 depthAxis_ = glm::vec4(0.0f);
+  IndirectRenderer *indirect_ = nullptr;
+  std::vector<DrawPacket> packets_;
+  // Clés dans l'ordre de soumission et tampon du tri, gardés d'une trame à
+  // l'autre.
+  std::vector<SortEntry> entries_, scratch_;
+  std::vector<const DrawPacket *> sorted_;
+};
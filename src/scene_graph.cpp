@@ -0,0 +1,36 @@
+#include "scene_graph.hpp"
+
+#include <algorithm>
+
+size_t SceneGraph::add(size_t parent, const glm::mat4 &local) {
+  parents_.push_back(parent);
+  locals_.push_back(local);
+  worlds_.push_back(local);
+  isDirty_.push_back(1);
+  return size() - 1;
+}
+
+void SceneGraph::setLocal(size_t node, const glm::mat4 &local) {
+  if (locals_[node] == local)
+    return;
+  locals_[node] = local;
+  isDirty_[node] = 1;
+}
+
+size_t SceneGraph::update() {
+  // Le parent d'un nœud le précède: sa matrice est déjà à jour, et son
+  // marqueur indique si celle du nœud doit être recalculée.
+  size_t nUpdated = 0;
+  for (size_t node = 0; node < size(); ++node) {
+    size_t parent = parents_[node];
+    if (parent != NO_PARENT && isDirty_[parent])
+      isDirty_[node] = 1;
+    if (!isDirty_[node])
+      continue;
+    worlds_[node] = parent == NO_PARENT ? locals_[node]
+                                        : worlds_[parent] * locals_[node];
+    ++nUpdated;
+  }
+  std::fill(isDirty_.begin(), isDirty_.end(), 0);
+  return nUpdated;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Hiérarchie de transformations: chaque nœud a une matrice locale, relative à
+// son parent, et une matrice dans le monde, gardée d'une mise à jour à
+// l'autre.
+//
+// Les nœuds sont rangés à plat, chacun après son parent, dans des tableaux
+// parallèles: update() les parcourt une seule fois dans l'ordre et ne
+// recalcule que les nœuds dont la matrice locale a changé et leurs
+// descendants.
+class SceneGraph {
+public:
+  static constexpr size_t NO_PARENT = SIZE_MAX;
+
+  // Ajoute un nœud enfant de parent, déjà ajouté (NO_PARENT pour une
+  // racine), et retourne son numéro.
+  size_t add(size_t parent, const glm::mat4 &local = glm::mat4(1.0f));
+
+  size_t size() const { return parents_.size(); }
+
+  const glm::mat4 &local(size_t node) const { return locals_[node]; }
+
+  // Change la matrice locale; le nœud n'est marqué modifié que si elle
+  // diffère.
+  void setLocal(size_t node, const glm::mat4 &local);
+
+  // Matrice dans le monde, à jour après update().
+  const glm::mat4 &world(size_t node) const { return worlds_[node]; }
+
+  // Recalcule les matrices dans le monde des nœuds modifiés depuis le dernier
+  // appel et de leurs descendants, et retourne leur nombre.
+  size_t update();
+
+private:
+  std::vector<size_t> parents_;
+  std::vector<glm::mat4> locals_;
+  std::vector<glm::mat4> worlds_;
+  std::vector<uint8_t> isDirty_;
+};
@@ -4,12 +4,44 @@
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aColor;
 
-uniform mat4 uMVP;
+// Caméra de la trame, commune à tous les dessins, et position des matrices
+// de la trame dans uObjectMatrices.
+layout(std140) uniform Camera
+{
+    mat4 uView;
+    mat4 uProjection;
+    int uObjectBase;
+};
+
+// Matrices de modèle de tous les objets de la trame, une colonne par texel.
+// Un dessin utilise la matrice uObjectBase + uObjectIndex, et chaque instance
+// d'un dessin instancié la suivante.
+uniform samplerBuffer uObjectMatrices;
+uniform int uObjectIndex;
+
+// Déquantification des positions : les positions snorm16 arrivent dans
+// [-1, 1] et sont ramenées dans la boîte englobante du modèle (identité pour
+// les modèles en float).
+uniform vec3 uPositionScale;
+uniform vec3 uPositionOffset;
+
 out vec3 vColor;
 
+mat4 objectMatrix(int object)
+{
+    int texel = (uObjectBase + object) * 4;
+    return mat4(texelFetch(uObjectMatrices, texel),
+                texelFetch(uObjectMatrices, texel + 1),
+                texelFetch(uObjectMatrices, texel + 2),
+                texelFetch(uObjectMatrices, texel + 3));
+}
+
 void main()
 {
     vColor = aColor;
-    // Transformation des sommets à l'aide de la matrice MVP.
-    gl_Position = uMVP * vec4(aPosition, 1.0);
+    // Transformation des sommets par les matrices de modèle, de vue et de
+    // projection.
+    vec3 position = aPosition * uPositionScale + uPositionOffset;
+    mat4 model = objectMatrix(uObjectIndex + gl_InstanceID);
+    gl_Position = uProjection * (uView * (model * vec4(position, 1.0)));
 }
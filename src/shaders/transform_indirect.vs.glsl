@@ -0,0 +1,50 @@
+#version 330 core
+
+// Variante de transform.vs.glsl pour les dessins indirects
+// (glMultiDrawElementsIndirect), où aucun uniforme ne peut changer entre les
+// dessins d'un même appel.
+
+// Entrées : position 3D et couleur par sommet.
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec3 aColor;
+
+// Données du dessin, lues une seule fois par commande : leur diviseur dépasse
+// tout nombre d'instances, l'enregistrement lu est donc celui du baseInstance
+// de la commande.
+layout(location = 2) in int aFirstObject;
+layout(location = 3) in vec3 aPositionScale;
+layout(location = 4) in vec3 aPositionOffset;
+layout(location = 5) in vec3 aColorMod;
+
+// Caméra de la trame, commune à tous les dessins, et position des matrices
+// de la trame dans uObjectMatrices.
+layout(std140) uniform Camera
+{
+    mat4 uView;
+    mat4 uProjection;
+    int uObjectBase;
+};
+
+// Matrices de modèle de tous les objets de la trame, une colonne par texel.
+uniform samplerBuffer uObjectMatrices;
+
+out vec3 vColor;
+
+mat4 objectMatrix(int object)
+{
+    int texel = (uObjectBase + object) * 4;
+    return mat4(texelFetch(uObjectMatrices, texel),
+                texelFetch(uObjectMatrices, texel + 1),
+                texelFetch(uObjectMatrices, texel + 2),
+                texelFetch(uObjectMatrices, texel + 3));
+}
+
+void main()
+{
+    // La modulation, constante sur tout le dessin, est appliquée ici;
+    // uColorMod vaut 1.
+    vColor = aColor * aColorMod;
+    vec3 position = aPosition * aPositionScale + aPositionOffset;
+    mat4 model = objectMatrix(aFirstObject + gl_InstanceID);
+    gl_Position = uProjection * (uView * (model * vec4(position, 1.0)));
+}
@@ -0,0 +1,123 @@
+#include "stream_buffer.hpp"
+
+#include "gl_state.hpp"
+
+#include <cstring>
+#include <iostream>
+
+using namespace gl;
+
+namespace {
+
+// Délai de chaque attente d'une barrière, en nanosecondes.
+const GLuint64 FENCE_WAIT_TIMEOUT = 1000000;
+
+size_t alignUp(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+StreamBuffer::~StreamBuffer() {
+  if (buffer_ == 0)
+    return;
+  for (GLsync &fence : fences_)
+    if (fence != nullptr)
+      glDeleteSync(fence);
+  if (mapped_ != nullptr) {
+    GlStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  }
+  glDeleteBuffers(1, &buffer_);
+}
+
+void StreamBuffer::create(size_t regionSize) {
+  regionSize_ = regionSize;
+  GLsizeiptr size = static_cast<GLsizeiptr>(regionSize * N_REGIONS);
+  glGenBuffers(1, &buffer_);
+  GlStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+  if (isGlVersionAtLeast(4, 4)) {
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr,
+                    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                        GL_MAP_COHERENT_BIT);
+    mapped_ = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size,
+                               GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                                   GL_MAP_COHERENT_BIT);
+  } else {
+    glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  }
+
+  // La première trame écrit dans la région 0.
+  region_ = N_REGIONS - 1;
+  head_ = 0;
+}
+
+void StreamBuffer::beginFrame() {
+  region_ = (region_ + 1) % N_REGIONS;
+  head_ = region_ * regionSize_;
+
+  if (isPersistent()) {
+    GLsync &fence = fences_[region_];
+    if (fence == nullptr)
+      return;
+    // La première attente vide la file de commandes pour que la barrière
+    // puisse être atteinte.
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                            FENCE_WAIT_TIMEOUT) == GL_TIMEOUT_EXPIRED) {
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+  } else if (region_ == 0) {
+    // Tampon plein: le pilote garde l'ancien espace pour les dessins en
+    // cours et en alloue un nouveau, qui peut être écrit sans attendre.
+    GlStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+    glBufferData(GL_COPY_WRITE_BUFFER,
+                 static_cast<GLsizeiptr>(regionSize_ * N_REGIONS), nullptr,
+                 GL_STREAM_DRAW);
+  }
+}
+
+GLintptr StreamBuffer::write(const void *data, size_t size,
+                             size_t alignment) {
+  size_t offset = alignUp(head_, alignment);
+  if (offset + size > (region_ + 1) * regionSize_) {
+    if (!isFullReported_) {
+      isFullReported_ = true;
+      std::cout << "Warning: StreamBuffer region of " << regionSize_
+                << " bytes is full, some draws are skipped." << std::endl;
+    }
+    return FULL;
+  }
+  head_ = offset + size;
+  if (size == 0)
+    return static_cast<GLintptr>(offset);
+
+  if (isPersistent()) {
+    std::memcpy(static_cast<char *>(mapped_) + offset, data, size);
+    return static_cast<GLintptr>(offset);
+  }
+
+  // Les plages écrites depuis le dernier abandon du tampon ne sont lues par
+  // aucun dessin en cours: pas besoin de synchronisation.
+  GlStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+  void *dst = glMapBufferRange(
+      GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+      static_cast<GLsizeiptr>(size),
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+          GL_MAP_UNSYNCHRONIZED_BIT);
+  if (dst != nullptr) {
+    std::memcpy(dst, data, size);
+    if (glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_TRUE)
+      return static_cast<GLintptr>(offset);
+  }
+
+  // La projection a échoué: on passe par une copie du pilote.
+  glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+                  static_cast<GLsizeiptr>(size), data);
+  return static_cast<GLintptr>(offset);
+}
+
+void StreamBuffer::endFrame() {
+  if (isPersistent())
+    fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, GL_NONE_BIT);
+}
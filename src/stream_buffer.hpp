@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glbinding/gl/gl.h>
+
+// Tampon circulaire pour les données réécrites à chaque trame (caméra,
+// matrices d'objets, commandes de dessin, sommets générés).
+//
+// Le tampon est divisé en N_REGIONS régions; chaque trame écrit dans la
+// suivante pendant que la carte graphique lit encore les précédentes. Avec
+// OpenGL 4.4, il est alloué par glBufferStorage et projeté une seule fois en
+// mémoire (persistant et cohérent); une barrière (glFenceSync) posée à la fin
+// de chaque trame garantit qu'une région n'est réécrite qu'une fois lue.
+// Sinon, chaque écriture projette sa plage sans synchronisation et le
+// tampon est abandonné au pilote (orphelin) lorsqu'il est plein.
+//
+// Les données d'une trame sont lues à la position retournée par write(),
+// dans le tampon buffer() qui ne change pas: les VAO, tampons de texture et
+// commandes peuvent y pointer une fois pour toutes.
+class StreamBuffer {
+public:
+  static constexpr size_t N_REGIONS = 3;
+
+  // Position retournée par write() quand la région de la trame est pleine.
+  static constexpr gl::GLintptr FULL = -1;
+
+  StreamBuffer() = default;
+
+  StreamBuffer(const StreamBuffer &) = delete;
+  StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+  ~StreamBuffer();
+
+  // Crée le tampon, de N_REGIONS régions d'au moins regionSize octets.
+  void create(size_t regionSize);
+
+  bool isPersistent() const { return mapped_ != nullptr; }
+
+  gl::GLuint buffer() const { return buffer_; }
+
+  // Passe à la région suivante, en attendant au besoin que la carte
+  // graphique ait fini de la lire.
+  void beginFrame();
+
+  // Copie size octets dans la région de la trame, à une position multiple de
+  // alignment, et retourne cette position dans le tampon. Si la région est
+  // pleine, n'écrit rien et retourne FULL: l'appelant saute alors les
+  // dessins qui auraient lu ces données, sans interrompre la trame.
+  gl::GLintptr write(const void *data, size_t size, size_t alignment);
+
+  template <typename T>
+  gl::GLintptr write(const std::vector<T> &data,
+                     size_t alignment = alignof(T)) {
+    return write(data.data(), data.size() * sizeof(T), alignment);
+  }
+
+  // Marque la fin des dessins qui lisent la région de la trame.
+  void endFrame();
+
+private:
+  gl::GLuint buffer_ = 0;
+  size_t regionSize_ = 0;
+  // Région de la trame et position de la prochaine écriture dans le tampon.
+  size_t region_ = 0;
+  size_t head_ = 0;
+  void *mapped_ = nullptr;
+  gl::GLsync fences_[N_REGIONS] = {};
+  bool isFullReported_ = false;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Ensemble fixe de fils d'exécution qui traitent les tâches soumises dans
+// l'ordre de soumission. Le destructeur termine les tâches en attente avant de
+// joindre les fils.
+class ThreadPool {
+public:
+  // Un fil par cœur si nThreads vaut 0.
+  explicit ThreadPool(size_t nThreads = 0);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t size() const { return workers_.size(); }
+
+  // Soumet une tâche. Le résultat, ou l'exception lancée par la tâche, est
+  // récupéré par le std::future retourné.
+  template <typename F> auto submit(F task) {
+    using Result = std::invoke_result_t<F>;
+    auto packaged =
+        std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    std::future<Result> result = packaged->get_future();
+    push([packaged]() { (*packaged)(); });
+    return result;
+  }
+
+private:
+  void push(std::function<void()> job);
+
+  void work();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> jobs_;
+  std::mutex mutex_;
+  std::condition_variable wakeUp_;
+  bool isStopping_ = false;
+};